@@ -0,0 +1,338 @@
+// Micro-benchmarks for every node kernel on synthetic images.
+//
+//   NodeImageBench [--sizes 1,12,48,100] [--filter TEXT] [--min-time SECONDS]
+//                  [--out results.json] [--baseline old.json] [--threshold PERCENT]
+//
+// Each case runs one node between an input and an output node, through the
+// same Pipeline/NodeGraph path the applications use, on a random 8-bit BGR
+// image of each size (in megapixels). Reported per case: median ns per pixel,
+// throughput in GB/s (input plus output bytes), and image buffer allocations
+// per run as seen by the BufferPool (all, and those not served from cache).
+//
+// Results are JSON, one case per line. With --baseline, each case is compared
+// with the same case in an earlier result file and the exit code is 1 if any
+// is slower by more than the threshold (default 10%).
+#include "Pipeline.h"
+#include "BufferPool.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct BenchCase {
+    std::string name;
+    GraphDesc::Node node;
+    bool blendOperand = false; // Feed the input to port 1 as well
+};
+
+struct Result {
+    std::string name;
+    int megapixels = 0;
+    int iterations = 0;
+    double nsPerPixel = 0.0;
+    double gbPerSecond = 0.0;
+    double allocations = 0.0;
+    double poolMisses = 0.0;
+};
+
+GraphDesc::Node node(const std::string& type, std::vector<GraphDesc::Param> params) {
+    return { type, std::move(params) };
+}
+
+std::vector<BenchCase> allCases() {
+    std::vector<BenchCase> cases;
+    cases.push_back({ "BrightnessContrast",
+                      node("BrightnessContrast", { { "brightness", { 20 } }, { "contrast", { 1.2f } } }) });
+    cases.push_back({ "ColorChannelSplitter",
+                      node("ColorChannelSplitter", { { "showGreen", { 0 } } }) });
+
+    const char* blurModes[] = { "uniform", "horizontal", "vertical" };
+    for (int radius : { 1, 5, 20 }) {
+        for (int mode = 0; mode < 3; ++mode) {
+            cases.push_back({ "Blur/r" + std::to_string(radius) + "/" + blurModes[mode],
+                              node("Blur", { { "enabled", { 1 } },
+                                             { "radius", { float(radius) } },
+                                             { "uniform", { mode == 0 ? 1.0f : 0.0f } },
+                                             { "horizontal", { mode == 1 ? 1.0f : 0.0f } } }) });
+        }
+    }
+    // Large radii, where the constant-time engines take over
+    const char* blurEngines[] = { "auto", "kernel", "recursive", "box" };
+    for (int radius : { 100, 400 }) {
+        for (int engine = 0; engine < 4; ++engine) {
+            cases.push_back({ "Blur/r" + std::to_string(radius) + "/" + blurEngines[engine],
+                              node("Blur", { { "enabled", { 1 } },
+                                             { "radius", { float(radius) } },
+                                             { "engine", { float(engine) } } }) });
+        }
+    }
+
+    const char* blendModes[] = { "Normal", "Multiply", "Screen", "Overlay", "Difference" };
+    for (int mode = 0; mode < 5; ++mode) {
+        cases.push_back({ std::string("Blend/") + blendModes[mode],
+                          node("Blend", { { "enabled", { 1 } }, { "mode", { float(mode) } }, { "opacity", { 0.5f } } }),
+                          true });
+    }
+
+    const char* thresholdMethods[] = { "Binary", "Otsu", "Adaptive" };
+    for (int method = 0; method < 3; ++method) {
+        cases.push_back({ std::string("Threshold/") + thresholdMethods[method],
+                          node("Threshold", { { "enabled", { 1 } }, { "method", { float(method) } } }) });
+    }
+
+    cases.push_back({ "EdgeDetection/Sobel",
+                      node("EdgeDetection", { { "method", { 0 } }, { "sobelKernelSize", { 3 } } }) });
+    cases.push_back({ "EdgeDetection/Canny", node("EdgeDetection", { { "method", { 1 } } }) });
+
+    // Width and height are filled in per image size
+    cases.push_back({ "NoiseGeneration", node("NoiseGeneration", { { "enabled", { 1 } } }) });
+
+    const char* presets[] = { "Custom", "Sharpen", "Emboss", "EdgeEnhance" };
+    for (int size : { 3, 5, 15, 63 }) {
+        for (int preset = 0; preset < 4; ++preset) {
+            std::vector<GraphDesc::Param> params = { { "enabled", { 1 } },
+                                                     { "kernelSize", { float(size) } },
+                                                     { "preset", { float(preset) } } };
+            if (preset == 0) // Custom: a box filter
+                params.push_back({ "kernel", std::vector<float>(size * size, 1.0f / (size * size)) });
+            cases.push_back({ std::string("ConvolutionFilter/") + presets[preset] + "/" +
+                                  std::to_string(size) + "x" + std::to_string(size),
+                              node("ConvolutionFilter", params) });
+        }
+    }
+    // A disc doesn't factor into few separable terms: runs dense
+    for (int size : { 15, 63 }) {
+        std::vector<float> disc(size * size);
+        int c = size / 2;
+        for (int y = 0; y < size; ++y)
+            for (int x = 0; x < size; ++x)
+                disc[y * size + x] = (x - c) * (x - c) + (y - c) * (y - c) <= c * c ? 1.0f : 0.0f;
+        float total = 0.0f;
+        for (float v : disc)
+            total += v;
+        for (float& v : disc)
+            v /= total;
+        cases.push_back({ "ConvolutionFilter/Disc/" + std::to_string(size) + "x" + std::to_string(size),
+                          node("ConvolutionFilter", { { "enabled", { 1 } },
+                                                      { "kernelSize", { float(size) } },
+                                                      { "preset", { 0 } },
+                                                      { "kernel", disc } }) });
+    }
+    return cases;
+}
+
+// 4:3 image of about the given number of megapixels
+cv::Mat syntheticImage(int megapixels) {
+    int width = static_cast<int>(std::sqrt(megapixels * 1e6 * 4.0 / 3.0));
+    int height = static_cast<int>(megapixels * 1e6 / width);
+    cv::Mat image(height, width, CV_8UC3);
+    cv::RNG rng(12345);
+    rng.fill(image, cv::RNG::UNIFORM, 0, 256);
+    return image;
+}
+
+bool runCase(const BenchCase& bench, const cv::Mat& image, int megapixels, double minSeconds, Result& result) {
+    GraphDesc desc;
+    desc.nodes.push_back(node("ImageInput", {}));
+    desc.nodes.push_back(bench.node);
+    desc.nodes.push_back(node("Output", {}));
+    desc.links.push_back({ 0, 0, 1, 0 });
+    desc.links.push_back({ 1, 0, 2, 0 });
+    if (bench.blendOperand)
+        desc.links.push_back({ 0, 0, 1, 1 });
+    if (bench.node.type == "NoiseGeneration") {
+        desc.nodes[1].params.push_back({ "width", { float(image.cols) } });
+        desc.nodes[1].params.push_back({ "height", { float(image.rows) } });
+    }
+
+    std::unique_ptr<Pipeline> pipeline = Pipeline::create(desc);
+    if (!pipeline)
+        return false;
+
+    // One warm-up run fills the buffer pool, as in steady interactive use
+    cv::Mat output = pipeline->process(image);
+    if (output.empty())
+        return false;
+
+    std::vector<double> times;
+    BufferPool::Stats before = BufferPool::instance().getStats();
+    double elapsed = 0.0;
+    while (times.size() < 3 || (elapsed < minSeconds && times.size() < 1000)) {
+        auto start = std::chrono::steady_clock::now();
+        output = pipeline->process(image); // New input generation: every node reruns
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        times.push_back(seconds);
+        elapsed += seconds;
+    }
+    BufferPool::Stats after = BufferPool::instance().getStats();
+
+    std::sort(times.begin(), times.end());
+    double median = times[times.size() / 2];
+    double pixels = static_cast<double>(image.total());
+    double bytes = static_cast<double>(image.total() * image.elemSize() + output.total() * output.elemSize());
+
+    result.name = bench.name;
+    result.megapixels = megapixels;
+    result.iterations = static_cast<int>(times.size());
+    result.nsPerPixel = median * 1e9 / pixels;
+    result.gbPerSecond = bytes / median / 1e9;
+    result.allocations = double(after.requests - before.requests) / times.size();
+    result.poolMisses = double((after.requests - after.hits) - (before.requests - before.hits)) / times.size();
+    return true;
+}
+
+std::string toJson(const Result& r) {
+    char buffer[512];
+    std::snprintf(buffer, sizeof(buffer),
+                  "{\"name\":\"%s\",\"megapixels\":%d,\"iterations\":%d,\"ns_per_pixel\":%.4f,"
+                  "\"gb_per_s\":%.3f,\"allocations\":%.2f,\"pool_misses\":%.2f}",
+                  r.name.c_str(), r.megapixels, r.iterations, r.nsPerPixel, r.gbPerSecond,
+                  r.allocations, r.poolMisses);
+    return buffer;
+}
+
+// Value following "key": on a line written by toJson()
+bool field(const std::string& line, const std::string& key, std::string& value) {
+    std::string tag = "\"" + key + "\":";
+    size_t pos = line.find(tag);
+    if (pos == std::string::npos)
+        return false;
+    pos += tag.size();
+    if (pos < line.size() && line[pos] == '"') {
+        size_t end = line.find('"', pos + 1);
+        if (end == std::string::npos)
+            return false;
+        value = line.substr(pos + 1, end - pos - 1);
+    } else {
+        size_t end = line.find_first_of(",}", pos);
+        value = line.substr(pos, end - pos);
+    }
+    return true;
+}
+
+// ns_per_pixel keyed by "name@megapixels"
+bool loadBaseline(const std::string& path, std::map<std::string, double>& baseline) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open baseline " << path << std::endl;
+        return false;
+    }
+    std::string line, name, megapixels, ns;
+    while (std::getline(file, line)) {
+        if (field(line, "name", name) && field(line, "megapixels", megapixels) && field(line, "ns_per_pixel", ns))
+            baseline[name + "@" + megapixels] = std::atof(ns.c_str());
+    }
+    return true;
+}
+
+std::vector<int> parseSizes(const std::string& list) {
+    std::vector<int> sizes;
+    std::stringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        int mp = std::atoi(item.c_str());
+        if (mp > 0)
+            sizes.push_back(mp);
+    }
+    return sizes;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes = { 1, 12, 48, 100 };
+    std::string filter;
+    std::string outPath;
+    std::string baselinePath;
+    double minSeconds = 1.0;
+    double threshold = 10.0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sizes" && hasValue) {
+            sizes = parseSizes(argv[++i]);
+        } else if (arg == "--filter" && hasValue) {
+            filter = argv[++i];
+        } else if (arg == "--min-time" && hasValue) {
+            minSeconds = std::atof(argv[++i]);
+        } else if (arg == "--out" && hasValue) {
+            outPath = argv[++i];
+        } else if (arg == "--baseline" && hasValue) {
+            baselinePath = argv[++i];
+        } else if (arg == "--threshold" && hasValue) {
+            threshold = std::atof(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--sizes 1,12,48,100] [--filter TEXT] [--min-time SECONDS]\n"
+                      << "       [--out results.json] [--baseline old.json] [--threshold PERCENT]" << std::endl;
+            return 2;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!baselinePath.empty() && !loadBaseline(baselinePath, baseline))
+        return 2;
+
+    BufferPool::install();
+    std::vector<BenchCase> cases = allCases();
+    std::vector<Result> results;
+    int regressions = 0;
+
+    for (int megapixels : sizes) {
+        cv::Mat image = syntheticImage(megapixels);
+        for (const BenchCase& bench : cases) {
+            if (!filter.empty() && bench.name.find(filter) == std::string::npos)
+                continue;
+            Result result;
+            if (!runCase(bench, image, megapixels, minSeconds, result)) {
+                std::cerr << "Failed: " << bench.name << " @ " << megapixels << " MP" << std::endl;
+                continue;
+            }
+            results.push_back(result);
+
+            // Progress and comparison go to stderr, so stdout stays valid JSON
+            std::fprintf(stderr, "%-36s %4d MP  %9.3f ns/px  %7.2f GB/s  %5.1f allocs",
+                         result.name.c_str(), megapixels, result.nsPerPixel, result.gbPerSecond, result.allocations);
+            auto old = baseline.find(result.name + "@" + std::to_string(megapixels));
+            if (old != baseline.end() && old->second > 0.0) {
+                double change = (result.nsPerPixel / old->second - 1.0) * 100.0;
+                bool regressed = change > threshold;
+                regressions += regressed;
+                std::fprintf(stderr, "  %+6.1f%%%s", change, regressed ? "  REGRESSION" : "");
+            }
+            std::fprintf(stderr, "\n");
+        }
+        BufferPool::instance().trim(); // Next size uses different buffers
+    }
+
+    std::string json = "{\"version\":1,\"results\":[\n";
+    for (size_t i = 0; i < results.size(); ++i)
+        json += toJson(results[i]) + (i + 1 < results.size() ? ",\n" : "\n");
+    json += "]}\n";
+
+    if (outPath.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream file(outPath);
+        if (!(file << json)) {
+            std::cerr << "Cannot write " << outPath << std::endl;
+            return 2;
+        }
+    }
+
+    if (regressions) {
+        std::cerr << regressions << " case(s) slower than baseline by more than " << threshold << "%" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "BatchProcessor.h"
+#include "BoundedQueue.h"
+#include "Profiler.h"
+#include <opencv2/imgcodecs.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+struct Item {
+    size_t job = 0;
+    cv::Mat image;
+};
+
+// Starts 'count' threads running body(threadIndex); the last one to finish
+// closes 'downstream' so the next stage knows no more items are coming.
+void startStage(std::vector<std::thread>& threads, size_t count, BoundedQueue<Item>* downstream,
+                std::function<void(size_t)> body) {
+    auto remaining = std::make_shared<std::atomic<size_t>>(count);
+    for (size_t i = 0; i < count; ++i) {
+        threads.emplace_back([=] {
+            body(i);
+            if (--*remaining == 0 && downstream)
+                downstream->close();
+        });
+    }
+}
+
+} // namespace
+
+BatchProcessor::BatchProcessor(PipelineFactory factory, const Options& options)
+    : factory(std::move(factory)), options(options) {}
+
+BatchProcessor::Result BatchProcessor::run(const std::vector<BatchJob>& jobs) {
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+
+    size_t workers = options.workers ? options.workers : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min(workers, std::max<size_t>(jobs.size(), 1));
+    size_t decoders = options.decoders ? options.decoders : workers;
+    size_t encoders = options.encoders ? options.encoders : workers;
+
+    // Nodes keep per-image state, so every worker gets its own pipeline
+    std::vector<std::unique_ptr<Pipeline>> pipelines;
+    for (size_t i = 0; i < workers; ++i) {
+        pipelines.push_back(factory());
+        if (!pipelines.back()) {
+            std::cerr << "BatchProcessor: failed to create pipeline" << std::endl;
+            result.failed = jobs.size();
+            return result;
+        }
+    }
+
+    // Workers already run in parallel. OpenCV's thread count stays as the
+    // application set it: concurrent parallel_for_ calls from the workers
+    // run on their own thread rather than oversubscribing the machine.
+
+    BoundedQueue<Item> decoded(options.queueDepth);
+    BoundedQueue<Item> processed(options.queueDepth);
+    std::atomic<size_t> nextJob{0};
+    std::atomic<size_t> succeeded{0};
+    std::atomic<size_t> failed{0};
+    std::mutex logMutex;
+    auto fail = [&](const BatchJob& job, const std::string& reason) {
+        ++failed;
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::cerr << "Failed: " << job.inputPath << ": " << reason << std::endl;
+    };
+
+    std::vector<std::thread> threads;
+    startStage(threads, decoders, &decoded, [&](size_t) {
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+            cv::Mat image;
+            try {
+                ProfileScope scope("decode", "io");
+                image = cv::imread(jobs[i].inputPath, cv::IMREAD_COLOR);
+            } catch (const std::exception& e) {
+                fail(jobs[i], e.what());
+                continue;
+            }
+            if (image.empty()) {
+                fail(jobs[i], "cannot decode");
+                continue;
+            }
+            decoded.push({ i, image });
+        }
+    });
+    startStage(threads, workers, &processed, [&](size_t worker) {
+        Item item;
+        while (decoded.pop(item)) {
+            cv::Mat output;
+            try {
+                // A region only costs the part of the image it depends on
+                if (options.region.empty())
+                    output = pipelines[worker]->process(item.image);
+                else
+                    output = pipelines[worker]->processRegion(item.image, options.region);
+            } catch (const std::exception& e) { // cv::Exception, bad_alloc, ...
+                fail(jobs[item.job], e.what());
+                continue;
+            }
+            if (output.empty()) {
+                fail(jobs[item.job], "pipeline produced no output");
+                continue;
+            }
+            processed.push({ item.job, output });
+        }
+    });
+    startStage(threads, encoders, nullptr, [&](size_t) {
+        Item item;
+        while (processed.pop(item)) {
+            const BatchJob& job = jobs[item.job];
+            bool written = false;
+            try {
+                ProfileScope scope("encode", "io");
+                written = cv::imwrite(job.outputPath, item.image);
+            } catch (const std::exception& e) {
+                fail(job, e.what());
+                continue;
+            }
+            if (!written) {
+                fail(job, "cannot write " + job.outputPath);
+                continue;
+            }
+            size_t done = ++succeeded;
+            std::lock_guard<std::mutex> lock(logMutex);
+            std::cout << "[" << done << "/" << jobs.size() << "] " << job.outputPath << std::endl;
+        }
+    });
+
+    for (std::thread& t : threads)
+        t.join();
+
+    result.succeeded = succeeded;
+    result.failed = failed;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Pipeline.h"
+#include <opencv2/core.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One image to process: read from inputPath, result written to outputPath
+struct BatchJob {
+    std::string inputPath;
+    std::string outputPath;
+};
+
+// Headless processing of many images through copies of one pipeline.
+//
+// Work flows through three stages connected by bounded queues:
+// decode (cv::imread) -> process (one Pipeline per worker) -> encode
+// (cv::imwrite). Each stage has its own threads, so file I/O overlaps with
+// processing, and the queue capacity limits how many decoded images are held
+// in memory at once.
+class BatchProcessor {
+public:
+    typedef std::function<std::unique_ptr<Pipeline>()> PipelineFactory;
+
+    struct Options {
+        size_t workers = 0;    // Processing threads; 0 = one per hardware thread
+        size_t decoders = 0;   // 0 = same as workers
+        size_t encoders = 0;   // 0 = same as workers
+        size_t queueDepth = 4; // Images buffered between two stages
+        cv::Rect region;       // Part of each image to output; empty = whole image
+    };
+
+    struct Result {
+        size_t succeeded = 0;
+        size_t failed = 0;
+        double seconds = 0.0;
+    };
+
+    BatchProcessor(PipelineFactory factory, const Options& options);
+
+    Result run(const std::vector<BatchJob>& jobs);
+
+private:
+    PipelineFactory factory;
+    Options options;
+};
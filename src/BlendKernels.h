@@ -0,0 +1,247 @@
+#pragma once
+#include "CancelToken.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BLEND_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// SSE4.1/AVX2 code paths are compiled with per-function target attributes and
+// picked at runtime, so the rest of the build needs no special flags
+#if defined(BLEND_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define BLEND_TARGET(isa) __attribute__((target(isa)))
+#else
+#define BLEND_TARGET(isa)
+#endif
+
+// Per-pixel blend kernels used by BlendNode.
+//
+// Every mode is a function f(A, B) on one channel sample; opacity mixes it
+// with the base image as A + (f(A, B) - A) * opacity. A row is processed as a
+// flat run of samples, so any channel count works as long as both inputs
+// match. 8-bit images use exact integer math with SSE4.1/AVX2 paths and a
+// scalar fallback; 16-bit and float images use a templated scalar loop.
+// Rows are split across threads with cv::parallel_for_.
+namespace BlendKernels {
+
+// x * y / 255, rounded, for x, y in [0, 255]
+inline int mul255(int x, int y) {
+    int t = x * y + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+#ifdef BLEND_KERNELS_X86
+BLEND_TARGET("sse4.1") inline __m128i mul255(__m128i x, __m128i y) {
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(x, y), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+BLEND_TARGET("avx2") inline __m256i mul255(__m256i x, __m256i y) {
+    __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(x, y), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+#endif
+
+// Blend operators. Each provides the 8-bit integer form (scalar and on
+// 16-bit SIMD lanes holding 0..255) and a floating point form where 'm' is
+// the maximum sample value of the image depth.
+struct Normal {
+    static int apply(int, int b) { return b; }
+    static float apply(float, float b, float) { return b; }
+#ifdef BLEND_KERNELS_X86
+    BLEND_TARGET("sse4.1") static __m128i apply(__m128i, __m128i b) { return b; }
+    BLEND_TARGET("avx2") static __m256i apply(__m256i, __m256i b) { return b; }
+#endif
+};
+
+struct Multiply {
+    static int apply(int a, int b) { return mul255(a, b); }
+    static float apply(float a, float b, float m) { return a * b / m; }
+#ifdef BLEND_KERNELS_X86
+    BLEND_TARGET("sse4.1") static __m128i apply(__m128i a, __m128i b) { return mul255(a, b); }
+    BLEND_TARGET("avx2") static __m256i apply(__m256i a, __m256i b) { return mul255(a, b); }
+#endif
+};
+
+struct Screen {
+    static int apply(int a, int b) { return 255 - mul255(255 - a, 255 - b); }
+    static float apply(float a, float b, float m) { return m - (m - a) * (m - b) / m; }
+#ifdef BLEND_KERNELS_X86
+    BLEND_TARGET("sse4.1") static __m128i apply(__m128i a, __m128i b) {
+        __m128i full = _mm_set1_epi16(255);
+        return _mm_sub_epi16(full, mul255(_mm_sub_epi16(full, a), _mm_sub_epi16(full, b)));
+    }
+    BLEND_TARGET("avx2") static __m256i apply(__m256i a, __m256i b) {
+        __m256i full = _mm256_set1_epi16(255);
+        return _mm256_sub_epi16(full, mul255(_mm256_sub_epi16(full, a), _mm256_sub_epi16(full, b)));
+    }
+#endif
+};
+
+struct Overlay {
+    static int apply(int a, int b) {
+        return a < 128 ? mul255(2 * a, b) : 255 - mul255(2 * (255 - a), 255 - b);
+    }
+    static float apply(float a, float b, float m) {
+        return a < m * 0.5f ? 2.0f * a * b / m : m - 2.0f * (m - a) * (m - b) / m;
+    }
+#ifdef BLEND_KERNELS_X86
+    BLEND_TARGET("sse4.1") static __m128i apply(__m128i a, __m128i b) {
+        __m128i full = _mm_set1_epi16(255);
+        __m128i dark = mul255(_mm_add_epi16(a, a), b);
+        __m128i invA = _mm_sub_epi16(full, a);
+        __m128i light = _mm_sub_epi16(full, mul255(_mm_add_epi16(invA, invA), _mm_sub_epi16(full, b)));
+        __m128i isDark = _mm_cmplt_epi16(a, _mm_set1_epi16(128));
+        return _mm_blendv_epi8(light, dark, isDark);
+    }
+    BLEND_TARGET("avx2") static __m256i apply(__m256i a, __m256i b) {
+        __m256i full = _mm256_set1_epi16(255);
+        __m256i dark = mul255(_mm256_add_epi16(a, a), b);
+        __m256i invA = _mm256_sub_epi16(full, a);
+        __m256i light = _mm256_sub_epi16(full, mul255(_mm256_add_epi16(invA, invA), _mm256_sub_epi16(full, b)));
+        __m256i isDark = _mm256_cmpgt_epi16(_mm256_set1_epi16(128), a);
+        return _mm256_blendv_epi8(light, dark, isDark);
+    }
+#endif
+};
+
+struct Difference {
+    static int apply(int a, int b) { return std::abs(a - b); }
+    static float apply(float a, float b, float) { return std::abs(a - b); }
+#ifdef BLEND_KERNELS_X86
+    BLEND_TARGET("sse4.1") static __m128i apply(__m128i a, __m128i b) { return _mm_abs_epi16(_mm_sub_epi16(a, b)); }
+    BLEND_TARGET("avx2") static __m256i apply(__m256i a, __m256i b) { return _mm256_abs_epi16(_mm256_sub_epi16(a, b)); }
+#endif
+};
+
+// (a * (256 - w) + f * w + 128) >> 8, with opacity as w in [0, 256]. The sum
+// never exceeds 255 * 256 + 128, so 16-bit lanes are enough.
+inline int mix(int a, int f, int w) {
+    return (a * (256 - w) + f * w + 128) >> 8;
+}
+
+template <class Op>
+void blendRowScalar(const uchar* a, const uchar* b, uchar* dst, int n, int w) {
+    for (int i = 0; i < n; ++i)
+        dst[i] = static_cast<uchar>(mix(a[i], Op::apply(int(a[i]), int(b[i])), w));
+}
+
+#ifdef BLEND_KERNELS_X86
+template <class Op>
+BLEND_TARGET("sse4.1") void blendRowSSE41(const uchar* a, const uchar* b, uchar* dst, int n, int w) {
+    const __m128i weight = _mm_set1_epi16(static_cast<short>(w));
+    const __m128i inverse = _mm_set1_epi16(static_cast<short>(256 - w));
+    const __m128i round = _mm_set1_epi16(128);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i out[2];
+        for (int half = 0; half < 2; ++half) {
+            __m128i a16 = _mm_cvtepu8_epi16(half ? _mm_srli_si128(va, 8) : va);
+            __m128i b16 = _mm_cvtepu8_epi16(half ? _mm_srli_si128(vb, 8) : vb);
+            __m128i f = Op::apply(a16, b16);
+            __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(a16, inverse),
+                                                      _mm_mullo_epi16(f, weight)), round);
+            out[half] = _mm_srli_epi16(sum, 8);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(out[0], out[1]));
+    }
+    blendRowScalar<Op>(a + i, b + i, dst + i, n - i, w);
+}
+
+template <class Op>
+BLEND_TARGET("avx2") void blendRowAVX2(const uchar* a, const uchar* b, uchar* dst, int n, int w) {
+    const __m256i weight = _mm256_set1_epi16(static_cast<short>(w));
+    const __m256i inverse = _mm256_set1_epi16(static_cast<short>(256 - w));
+    const __m256i round = _mm256_set1_epi16(128);
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i out[2];
+        for (int half = 0; half < 2; ++half) {
+            __m256i a16 = _mm256_cvtepu8_epi16(half ? _mm256_extracti128_si256(va, 1) : _mm256_castsi256_si128(va));
+            __m256i b16 = _mm256_cvtepu8_epi16(half ? _mm256_extracti128_si256(vb, 1) : _mm256_castsi256_si128(vb));
+            __m256i f = Op::apply(a16, b16);
+            __m256i sum = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(a16, inverse),
+                                                            _mm256_mullo_epi16(f, weight)), round);
+            out[half] = _mm256_srli_epi16(sum, 8);
+        }
+        // packus works per 128-bit lane; restore sample order afterwards
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(out[0], out[1]), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    blendRowScalar<Op>(a + i, b + i, dst + i, n - i, w);
+}
+#endif
+
+template <class Op, typename T>
+void blendRowFloat(const T* a, const T* b, T* dst, int n, float opacity, float m) {
+    for (int i = 0; i < n; ++i) {
+        float fa = static_cast<float>(a[i]);
+        float f = Op::apply(fa, static_cast<float>(b[i]), m);
+        dst[i] = cv::saturate_cast<T>(fa + (f - fa) * opacity);
+    }
+}
+
+// 8-bit row kernel: n samples of a and b into dst, opacity w in [0, 256]
+typedef void (*Row8)(const uchar* a, const uchar* b, uchar* dst, int n, int w);
+
+// Fastest row kernel the CPU supports
+template <class Op>
+Row8 rowKernel() {
+#ifdef BLEND_KERNELS_X86
+    if (cv::checkHardwareSupport(cv::CPU_AVX2))
+        return blendRowAVX2<Op>;
+    if (cv::checkHardwareSupport(cv::CPU_SSE4_1))
+        return blendRowSSE41<Op>;
+#endif
+    return blendRowScalar<Op>;
+}
+
+inline int opacityWeight(float opacity) {
+    return static_cast<int>(std::lround(std::min(std::max(opacity, 0.0f), 1.0f) * 256.0f));
+}
+
+// Blends whole images; a, b and dst must have the same size and type. Once
+// 'cancel' is raised the remaining rows are skipped, leaving dst unfinished.
+template <class Op>
+void blend(const cv::Mat& a, const cv::Mat& b, cv::Mat& dst, float opacity,
+           const CancelToken* cancel = nullptr) {
+    Row8 row8 = rowKernel<Op>();
+    int depth = a.depth();
+    int samples = a.cols * a.channels();
+    int w = opacityWeight(opacity);
+
+    cv::parallel_for_(cv::Range(0, a.rows), [&](const cv::Range& rows) {
+        for (int y = rows.start; y < rows.end; ++y) {
+            if ((y & 63) == 0 && cancel && cancel->isCancelled())
+                return;
+            switch (depth) {
+                case CV_8U:
+                    row8(a.ptr<uchar>(y), b.ptr<uchar>(y), dst.ptr<uchar>(y), samples, w);
+                    break;
+                case CV_16U:
+                    blendRowFloat<Op>(a.ptr<ushort>(y), b.ptr<ushort>(y), dst.ptr<ushort>(y),
+                                      samples, opacity, 65535.0f);
+                    break;
+                case CV_32F:
+                    blendRowFloat<Op>(a.ptr<float>(y), b.ptr<float>(y), dst.ptr<float>(y),
+                                      samples, opacity, 1.0f);
+                    break;
+            }
+        }
+    });
+}
+
+// True for the depths blend() handles
+inline bool supportsDepth(int depth) {
+    return depth == CV_8U || depth == CV_16U || depth == CV_32F;
+}
+
+} // namespace BlendKernels
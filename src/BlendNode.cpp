@@ -1,6 +1,7 @@
 #include "BlendNode.h"
+#include "BlendKernels.h"
 #include <opencv2/imgproc.hpp>
-#include <imgui.h>
+#include <cmath>
 #include <iostream>
 
 BlendNode::BlendNode()
@@ -10,12 +11,19 @@ BlendNode::BlendNode()
       useBlend(false),     // Default set to false; original image is used if blending is not enabled.
       processed(false)
 {
+    inputPorts = { { "A" }, { "B", PortType::Image, true } };
 }
 
 void BlendNode::setBlendImage(const cv::Mat& imageA, const cv::Mat& imageB) {
     inputImage = imageA;       // Primary image
     blendImage = imageB;       // The image to blend with
-    dirty = true;              // Mark dirty so that process() knows it must update
+}
+
+void BlendNode::setInput(int port, const cv::Mat& image) {
+    if (port == 0)
+        inputImage = image;    // Primary image (A)
+    else if (port == 1)
+        blendImage = image;    // Image to blend with (B)
 }
 
 const cv::Mat& BlendNode::getOutputImage() const {
@@ -23,125 +31,149 @@ const cv::Mat& BlendNode::getOutputImage() const {
 }
 
 void BlendNode::process() {
-    // Only process when dirty is true
-    if (!dirty)
-        return;
-    
+    // Snapshot parameters; the UI may edit them while we compute
+    BlendMode mode;
+    float alpha;
+    bool enabled;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        mode = blendMode;
+        alpha = opacity;
+        enabled = useBlend;
+    }
+
     if (inputImage.empty()) {
         std::cerr << "BlendNode::process(): Primary input image is empty." << std::endl;
-        dirty = false;
         return;
     }
     
     // If blending is not enabled, output the original image.
-    if (!useBlend) {
-        outputImage = inputImage.clone();
-        dirty = false;
+    if (!enabled) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        outputImage = inputImage; // Shared, not copied
         return;
     }
     
     if (blendImage.empty()) {
         std::cerr << "BlendNode::process(): Blend image is empty." << std::endl;
         // If blend image is missing, pass through the original image.
-        outputImage = inputImage.clone();
-        dirty = false;
+        std::lock_guard<std::mutex> lock(stateMutex);
+        outputImage = inputImage; // Shared, not copied
         return;
     }
     
-    cv::Mat imgA, imgB;
-    inputImage.copyTo(imgA);
+    // Inputs are read-only shared buffers; only the resize/convert below
+    // allocate, and only when needed.
+    cv::Mat imgA = inputImage, imgB, dst;
     
     // Ensure the blend image is resized to match imgA if needed
     if (inputImage.size() != blendImage.size())
         cv::resize(blendImage, imgB, inputImage.size());
     else
-        blendImage.copyTo(imgB);
+        imgB = blendImage;
     
-    // Convert blend image to the same type if different
+    // Match B's channel count and depth to A's
+    if (imgB.channels() != imgA.channels()) {
+        cv::Mat converted;
+        if (!matchChannels(imgB, imgA.channels(), converted)) {
+            std::cerr << "BlendNode::process(): Cannot blend " << imgA.channels() << "-channel and "
+                      << imgB.channels() << "-channel images." << std::endl;
+            return;
+        }
+        imgB = converted;
+    }
     if (imgA.type() != imgB.type()) {
-        imgB.convertTo(imgB, imgA.type());
+        cv::Mat converted;
+        imgB.convertTo(converted, imgA.type());
+        imgB = converted;
+    }
+    if (!BlendKernels::supportsDepth(imgA.depth())) {
+        std::cerr << "BlendNode::process(): Unsupported image depth." << std::endl;
+        return;
     }
     
-    // Perform blending based on the selected blend mode
-    switch (blendMode) {
+    // One pass over both images, opacity applied the same way for every mode
+    dst.create(imgA.size(), imgA.type());
+    switch (mode) {
         case BlendMode::Normal:
-            cv::addWeighted(imgA, opacity, imgB, 1.0f - opacity, 0.0, outputImage);
+            BlendKernels::blend<BlendKernels::Normal>(imgA, imgB, dst, alpha, cancelToken);
             break;
-            
         case BlendMode::Multiply:
-            cv::multiply(imgA, imgB, outputImage, opacity / 255.0);
+            BlendKernels::blend<BlendKernels::Multiply>(imgA, imgB, dst, alpha, cancelToken);
             break;
-            
-        case BlendMode::Screen: {
-            cv::Mat invA, invB, blended;
-            cv::subtract(cv::Scalar::all(255), imgA, invA);
-            cv::subtract(cv::Scalar::all(255), imgB, invB);
-            cv::multiply(invA, invB, blended, 1.0 / 255.0);
-            cv::subtract(cv::Scalar::all(255), blended, blended);
-            cv::addWeighted(imgA, 1.0f - opacity, blended, opacity, 0.0, outputImage);
+        case BlendMode::Screen:
+            BlendKernels::blend<BlendKernels::Screen>(imgA, imgB, dst, alpha, cancelToken);
             break;
-        }
-            
-        case BlendMode::Overlay: {
-            outputImage = imgA.clone();
-            for (int y = 0; y < imgA.rows; y++) {
-                for (int x = 0; x < imgA.cols; x++) {
-                    for (int c = 0; c < imgA.channels(); c++) {
-                        uchar A = imgA.at<cv::Vec3b>(y, x)[c];
-                        uchar B = imgB.at<cv::Vec3b>(y, x)[c];
-                        float result = (A < 128)
-                            ? (2.0f * A * B / 255.0f)
-                            : (255.0f - 2.0f * (255.0f - A) * (255.0f - B) / 255.0f);
-                        outputImage.at<cv::Vec3b>(y, x)[c] =
-                            cv::saturate_cast<uchar>(result * opacity + A * (1.0f - opacity));
-                    }
-                }
-            }
+        case BlendMode::Overlay:
+            BlendKernels::blend<BlendKernels::Overlay>(imgA, imgB, dst, alpha, cancelToken);
             break;
-        }
-            
         case BlendMode::Difference:
-            cv::absdiff(imgA, imgB, outputImage);
+            BlendKernels::blend<BlendKernels::Difference>(imgA, imgB, dst, alpha, cancelToken);
             break;
-        
         default:
             std::cerr << "BlendNode::process(): Unknown blend mode!" << std::endl;
-            break;
+            return;
     }
+    if (isCancelled())
+        return; // Rows were skipped; publish nothing
     
+    std::lock_guard<std::mutex> lock(stateMutex);
+    outputImage = dst;
     processed = true;
-    dirty = false;  // Processing complete
 }
 
-void BlendNode::drawUI() {
-    ImGui::Text("Blend Node");
+bool BlendNode::getPointOps(std::vector<PointOp>& ops) const {
+    // B must already match A; otherwise process() resizes/converts it
+    if (blendImage.empty() || blendImage.depth() != CV_8U)
+        return false;
 
-    bool changed = false;
-    
-    // Checkbox for enabling blending
-    changed |= ImGui::Checkbox("Enable Blending", &useBlend);
-    
-    const char* modes[] = { "Normal", "Multiply", "Screen", "Overlay", "Difference" };
-    int currentMode = static_cast<int>(blendMode);
-    if (ImGui::Combo("Blend Mode", &currentMode, modes, IM_ARRAYSIZE(modes))) {
-        blendMode = static_cast<BlendMode>(currentMode);
-        changed = true;
-    }
-
-    if (ImGui::SliderFloat("Opacity", &opacity, 0.0f, 1.0f)) {
-        changed = true;
+    PointOp op;
+    op.kind = PointOp::Blend;
+    op.operand = blendImage;
+    op.weight = BlendKernels::opacityWeight(opacity);
+    switch (blendMode) {
+        case BlendMode::Normal:     op.blendRow = BlendKernels::rowKernel<BlendKernels::Normal>(); break;
+        case BlendMode::Multiply:   op.blendRow = BlendKernels::rowKernel<BlendKernels::Multiply>(); break;
+        case BlendMode::Screen:     op.blendRow = BlendKernels::rowKernel<BlendKernels::Screen>(); break;
+        case BlendMode::Overlay:    op.blendRow = BlendKernels::rowKernel<BlendKernels::Overlay>(); break;
+        case BlendMode::Difference: op.blendRow = BlendKernels::rowKernel<BlendKernels::Difference>(); break;
+        default: return false;
     }
+    ops.push_back(op);
+    return true;
+}
 
-    if (changed) {
-        dirty = true;
+// Converts between gray, BGR and BGRA. Returns false for other combinations.
+bool BlendNode::matchChannels(const cv::Mat& src, int channels, cv::Mat& dst) {
+    int code = -1;
+    switch (src.channels() * 10 + channels) {
+        case 13: code = cv::COLOR_GRAY2BGR; break;
+        case 14: code = cv::COLOR_GRAY2BGRA; break;
+        case 31: code = cv::COLOR_BGR2GRAY; break;
+        case 34: code = cv::COLOR_BGR2BGRA; break;
+        case 41: code = cv::COLOR_BGRA2GRAY; break;
+        case 43: code = cv::COLOR_BGRA2BGR; break;
     }
+    if (code < 0)
+        return false;
+    cv::cvtColor(src, dst, code);
+    return true;
+}
 
-    if (!outputImage.empty()) {
-        ImGui::Text("Output image ready.");
-    } else {
-        ImGui::Text("No output image.");
-    }
-    if (ImGui::Button("Reset")) {
-        reset(); // Call the reset method
+bool BlendNode::getInputRegion(int port, const cv::Rect& outputRegion, cv::Rect& inputRegion) const {
+    // Output pixels line up with A's; B is resized onto A when sizes differ
+    if (port == 0 || !useBlend || inputImage.empty() || blendImage.empty() ||
+        inputImage.size() == blendImage.size()) {
+        inputRegion = outputRegion;
+        return true;
     }
+    double fx = static_cast<double>(blendImage.cols) / inputImage.cols;
+    double fy = static_cast<double>(blendImage.rows) / inputImage.rows;
+    // One extra pixel for the neighbours bilinear resizing reads
+    cv::Point tl(static_cast<int>(std::floor(outputRegion.x * fx)) - 1,
+                 static_cast<int>(std::floor(outputRegion.y * fy)) - 1);
+    cv::Point br(static_cast<int>(std::ceil(outputRegion.br().x * fx)) + 1,
+                 static_cast<int>(std::ceil(outputRegion.br().y * fy)) + 1);
+    inputRegion = cv::Rect(tl, br);
+    return true;
 }
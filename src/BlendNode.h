@@ -15,11 +15,23 @@ public:
     BlendNode();
 
     void process() override;
-    void drawUI() override;
+    const char* getTypeName() const override { return "Blend"; }
+    void visitParams(ParamVisitor& v) override {
+        v.visit("enabled", useBlend);
+        v.visit("mode", blendMode);
+        v.visit("opacity", opacity);
+        clampParam(blendMode, BlendMode::Normal, BlendMode::Difference);
+        clampParam(opacity, 0.0f, 1.0f);
+    }
+    friend class NodePanels; // Property panel, drawn by the GUI
 
     // Set the two input images (A and B)
     void setBlendImage(const cv::Mat& imageA, const cv::Mat& imageB);
+    void setInput(int port, const cv::Mat& image) override;
     const cv::Mat& getOutputImage() const;
+    bool isPassThrough() const override { return !useBlend; }
+    bool getPointOps(std::vector<PointOp>& ops) const override;
+    bool getInputRegion(int port, const cv::Rect& outputRegion, cv::Rect& inputRegion) const override;
     void reset() override {
         NodeBase::reset(); // Call base class reset
         blendMode = BlendMode::Normal; // Default blend mode
@@ -28,9 +40,9 @@ public:
     }
 
 private:
-    cv::Mat inputImage;    // Primary image
-    cv::Mat blendImage;    // Image to blend with
-    cv::Mat outputImage;   // Result image 
+    static bool matchChannels(const cv::Mat& src, int channels, cv::Mat& dst);
+
+    cv::Mat blendImage;    // Image to blend with (primary image is NodeBase::inputImage)
     BlendMode blendMode;
     float opacity;        // Blend strength [0.0 - 1.0]
     bool processed;     // Flag to indicate if the image has been processed
@@ -1,6 +1,7 @@
 #include "BlurNode.h"
-#include <imgui.h>
 #include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 BlurNode::BlurNode()
@@ -17,71 +18,120 @@ void BlurNode::setInputImage(const cv::Mat& image) {
     if (image.empty())
         return;
     inputImage = image;
-    dirty = true;
 }
 
 const cv::Mat& BlurNode::getOutputImage() const {
-    if (!useBlurNode || outputImage.empty())
-        return inputImage;
     return outputImage;
 }
 
 void BlurNode::process() {
     if (inputImage.empty()) return;
 
-    if (!useBlurNode) {
-        outputImage = inputImage.clone();  // Just clone original to maintain consistency
+    // Snapshot parameters; the UI may edit them while we compute
+    int radius;
+    bool uniform, horizontal, enabled;
+    BlurEngine blurEngine;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        radius = blurRadius;
+        uniform = uniformBlur;
+        horizontal = directionHorizontal;
+        enabled = useBlurNode;
+        blurEngine = engine;
+    }
+
+    if (!enabled) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        outputImage = inputImage;  // Forward the shared buffer
         processed = true;
-        dirty = false;
         return;
     }
 
-    int kernelSize = blurRadius * 2 + 1;
-
-    if (uniformBlur) {
-        cv::GaussianBlur(inputImage, outputImage, cv::Size(kernelSize, kernelSize), 0);
+    int kernelSize = radius * 2 + 1;
+    cv::Mat result;
+
+    LargeBlur::Method method;
+    bool constantTime = usesLargeBlur(blurEngine, radius, method);
+    if (constantTime) {
+        LargeBlur::blur(inputImage, result, LargeBlur::sigmaForRadius(radius),
+                        uniform || horizontal, uniform || !horizontal, method, cancelToken);
+        if (isCancelled())
+            return;
+    } else if (uniform) {
+        cv::GaussianBlur(inputImage, result, cv::Size(kernelSize, kernelSize), 0);
     } else {
-        if (directionHorizontal)
-            cv::GaussianBlur(inputImage, outputImage, cv::Size(kernelSize, 1), 0);
+        if (horizontal)
+            cv::GaussianBlur(inputImage, result, cv::Size(kernelSize, 1), 0);
         else
-            cv::GaussianBlur(inputImage, outputImage, cv::Size(1, kernelSize), 0);
+            cv::GaussianBlur(inputImage, result, cv::Size(1, kernelSize), 0);
     }
 
-    // Generate 1D kernel preview
-    cv::Mat kernel = cv::getGaussianKernel(kernelSize, -1, CV_32F);
-    kernelPreview = (uniformBlur || directionHorizontal) ? kernel.t() : kernel;
+    // 1D kernel preview; the constant-time engines have no kernel, and
+    // building one of up to 1001 taps would cost more than they save
+    cv::Mat kernel;
+    if (!constantTime) {
+        kernel = cv::getGaussianKernel(kernelSize, -1, CV_32F);
+        if (uniform || horizontal)
+            kernel = kernel.t();
+    }
 
+    std::lock_guard<std::mutex> lock(stateMutex);
+    outputImage = result;
+    kernelPreview = kernel;
     processed = true;
-    dirty = false;
 }
 
-void BlurNode::drawUI() {
-    ImGui::Text("Blur Node");
+bool BlurNode::usesLargeBlur(BlurEngine engine, int radius, LargeBlur::Method& method) {
+    // Below the engines' range (small radii, e.g. scaled down on a proxy)
+    // the kernel is cheap anyway
+    if (LargeBlur::sigmaForRadius(radius) < LargeBlur::kMinSigma)
+        return false;
+    switch (engine) {
+        case BlurEngine::Auto:
+            method = LargeBlur::Method::Recursive;
+            return radius > kConstantTimeRadius;
+        case BlurEngine::Kernel:
+            return false;
+        case BlurEngine::Recursive:
+            method = LargeBlur::Method::Recursive;
+            return true;
+        case BlurEngine::Box:
+            method = LargeBlur::Method::Box;
+            return true;
+    }
+    return false;
+}
 
-    bool changed = false;
+void BlurNode::scaleParams(double factor) {
+    blurRadius = std::max(0, static_cast<int>(std::lround(blurRadius * factor)));
+}
 
-    changed |= ImGui::Checkbox("Use Blur Node", &useBlurNode);
-    changed |= ImGui::SliderInt("Blur Radius", &blurRadius, 1, 20);
-    changed |= ImGui::Checkbox("Uniform Blur (2D)", &uniformBlur);
+bool BlurNode::getTileKernel(TileKernel& kernel) const {
+    // The constant-time engines run whole rows; tiles would each redo the
+    // recursion's long start-up over a halo wider than themselves
+    LargeBlur::Method method;
+    if (usesLargeBlur(engine, blurRadius, method))
+        return false;
 
+    int kernelSize = blurRadius * 2 + 1;
+    cv::Size ksize(kernelSize, kernelSize);
     if (!uniformBlur)
-        changed |= ImGui::Checkbox("Horizontal Blur", &directionHorizontal);
-
-    if (changed) dirty = true;
-
-    if (dirty) process();
+        ksize = directionHorizontal ? cv::Size(kernelSize, 1) : cv::Size(1, kernelSize);
 
-    if (!kernelPreview.empty() && useBlurNode) {
-        ImGui::Text("Kernel Preview:");
-        for (int i = 0; i < kernelPreview.cols; ++i) {
-            float val = kernelPreview.at<float>(0, i);
-            ImGui::SameLine();
-            ImGui::Text("%.3f", val);
-        }
-    }
+    kernel.halo = blurRadius;
+    kernel.apply = [ksize](const cv::Mat& src, const cv::Rect&, cv::Mat& dst) {
+        cv::GaussianBlur(src, dst, ksize, 0);
+    };
+    return true;
+}
 
-    ImGui::Text("%s", getOutputImage().empty() ? "No output image." : "Output image ready.");
-    if (ImGui::Button("Reset")) {
-        reset(); // Call the reset method
-    }
+bool BlurNode::getInputRegion(int, const cv::Rect& outputRegion, cv::Rect& inputRegion) const {
+    int radius = useBlurNode ? blurRadius : 0;
+    LargeBlur::Method method;
+    if (useBlurNode && usesLargeBlur(engine, blurRadius, method))
+        radius = LargeBlur::reach(LargeBlur::sigmaForRadius(blurRadius), method);
+    int dx = (uniformBlur || directionHorizontal) ? radius : 0;
+    int dy = (uniformBlur || !directionHorizontal) ? radius : 0;
+    inputRegion = growRegion(outputRegion, dx, dy);
+    return true;
 }
@@ -1,28 +1,57 @@
 #pragma once
 
+#include "LargeBlur.h"
 #include "NodeBase.h"
 #include <opencv2/core.hpp>
 
+// How the blur is computed. Kernel is cv::GaussianBlur, whose cost grows with
+// the radius; Recursive and Box are LargeBlur's constant-time approximations.
+// Auto uses the kernel up to kConstantTimeRadius and Recursive above it.
+enum class BlurEngine { Auto, Kernel, Recursive, Box };
+
 class BlurNode : public NodeBase {
 public:
+    // Radius above which Auto switches to the constant-time engine
+    static constexpr int kConstantTimeRadius = 16;
+    static constexpr int kMaxRadius = 500;
+
     BlurNode();
 
     void setInputImage(const cv::Mat& image);
     const cv::Mat& getOutputImage() const ;
     void process() override;
-    void drawUI() override;
+    const char* getTypeName() const override { return "Blur"; }
+    void visitParams(ParamVisitor& v) override {
+        v.visit("enabled", useBlurNode);
+        v.visit("radius", blurRadius);
+        v.visit("uniform", uniformBlur);
+        v.visit("horizontal", directionHorizontal);
+        v.visit("engine", engine);
+        clampParam(blurRadius, 0, kMaxRadius);
+        clampParam(engine, BlurEngine::Auto, BlurEngine::Box);
+    }
+    void scaleParams(double factor) override;
+    friend class NodePanels; // Property panel, drawn by the GUI
+    bool isPassThrough() const override { return !useBlurNode; }
+    bool getTileKernel(TileKernel& kernel) const override;
+    bool getInputRegion(int port, const cv::Rect& outputRegion, cv::Rect& inputRegion) const override;
     void reset() override {
         NodeBase::reset(); // Call base class reset
         blurRadius = 5; // Default radius
         uniformBlur = true; // Default to uniform blur
         directionHorizontal = true; // Default to horizontal direction
         useBlurNode = false; // Default to disabled
+        engine = BlurEngine::Auto;
     }
 private:
+    // Whether 'engine' runs the constant-time blur at this radius, and which
+    static bool usesLargeBlur(BlurEngine engine, int radius, LargeBlur::Method& method);
+
     int blurRadius;
     bool uniformBlur;
     bool directionHorizontal;
     bool useBlurNode;
+    BlurEngine engine = BlurEngine::Auto;
     bool processed;
 
     cv::Mat kernelPreview;  // For displaying the kernel
@@ -9,31 +9,50 @@ BrightnessContrastNode::BrightnessContrastNode()
 
 void BrightnessContrastNode::process() {
     if (inputImage.empty()) {
-        std::cout << "BrightnessContrastNode::process(): inputImage is empty" << std::endl;
+        std::cerr << "BrightnessContrastNode::process(): inputImage is empty" << std::endl;
         return;
     }
 
-    inputImage.convertTo(outputImage, -1, contrast, brightness);
-    processed = true; // Mark as processed
-    dirty = false;
+    // Snapshot parameters; the UI may edit them while we compute
+    float alpha, beta;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        alpha = contrast;
+        beta = brightness;
+    }
+
+    cv::Mat result;
+    inputImage.convertTo(result, -1, alpha, beta);
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        outputImage = result;
+        processed = true; // Mark as processed
+    }
+}
+
+bool BrightnessContrastNode::getTileKernel(TileKernel& kernel) const {
+    float alpha = contrast, beta = brightness;
+    kernel.halo = 0; // Point-wise
+    kernel.apply = [alpha, beta](const cv::Mat& src, const cv::Rect&, cv::Mat& dst) {
+        src.convertTo(dst, -1, alpha, beta);
+    };
+    return true;
+}
 
-    double minVal, maxVal;
-    cv::minMaxLoc(outputImage, &minVal, &maxVal);
-    std::cout << "BrightnessContrastNode::process():" << std::endl;
-    std::cout << "  Output image size: " << outputImage.cols << " x " << outputImage.rows << std::endl;
-    std::cout << "  Pixel value range: " << minVal << " to " << maxVal << std::endl;
-    // debugImage(outputImage, "BrightnessContrastNode");
+bool BrightnessContrastNode::getPointOps(std::vector<PointOp>& ops) const {
+    // Same float math and rounding as convertTo() on 8-bit images
+    PointOp op;
+    op.tables.resize(1);
+    for (int v = 0; v < 256; ++v)
+        op.tables[0][v] = cv::saturate_cast<uchar>(v * contrast + brightness);
+    ops.push_back(op);
+    return true;
 }
 
 void BrightnessContrastNode::setInputImage(const cv::Mat& image) {
-    if (image.size() != inputImage.size() || 
-        image.type() != inputImage.type() || 
-        cv::norm(image, inputImage) > 1e-6) {  // Tolerance-based comparison
-        inputImage = image;
-        dirty = true; // Mark as needing processing
-        std::cout << "BrightnessContrastNode::setInputImage(): " 
-                  << image.cols << " x " << image.rows << std::endl;
-    }
+    // Change detection is done by generation in NodeBase::feedInput(), so no
+    // pixel comparison is needed here.
+    inputImage = image;
 }
 
 const cv::Mat& BrightnessContrastNode::getOutputImage() const {
@@ -43,17 +62,3 @@ const cv::Mat& BrightnessContrastNode::getOutputImage() const {
 bool BrightnessContrastNode::isImageProcessed() const {
     return !outputImage.empty();
 }
-
-void BrightnessContrastNode::drawUI() {
-    ImGui::Text("Brightness/Contrast Node");
-    bool changed = false;
-    changed |= ImGui::SliderFloat("Brightness", &brightness, -100.0f, 100.0f);
-    changed |= ImGui::SliderFloat("Contrast", &contrast, 0.0f, 3.0f);
-
-    if (changed) {
-        dirty = true;  // Mark dirty if user changes sliders
-    }
-    if (ImGui::Button("Reset")) {
-        reset(); // Call the reset method
-    }
-}
\ No newline at end of file
@@ -3,14 +3,26 @@
 
 #include "NodeBase.h"
 #include <opencv2/opencv.hpp>
-#include <imgui.h>
 
 class BrightnessContrastNode : public NodeBase {
 public:
     BrightnessContrastNode();
     
     void process() override;
-    void drawUI() override;
+    const char* getTypeName() const override { return "BrightnessContrast"; }
+    void visitParams(ParamVisitor& v) override {
+        v.visit("brightness", brightness);
+        v.visit("contrast", contrast);
+        clampParam(brightness, -255.0f, 255.0f);
+        clampParam(contrast, 0.0f, 100.0f);
+    }
+    friend class NodePanels; // Property panel, drawn by the GUI
+    bool getTileKernel(TileKernel& kernel) const override;
+    bool getPointOps(std::vector<PointOp>& ops) const override;
+    bool getInputRegion(int, const cv::Rect& outputRegion, cv::Rect& inputRegion) const override {
+        inputRegion = outputRegion; // Point-wise
+        return true;
+    }
     bool isImageProcessed() const;
 
     void setInputImage(const cv::Mat& image);
@@ -0,0 +1,139 @@
+#include "BufferPool.h"
+#include <algorithm>
+
+BufferPool& BufferPool::instance() {
+    static BufferPool* pool = new BufferPool();
+    return *pool;
+}
+
+void BufferPool::install() {
+    cv::Mat::setDefaultAllocator(&instance());
+}
+
+BufferPool::BufferPool(size_t maxCachedBytes) : maxCachedBytes(maxCachedBytes) {}
+
+// Rounds up to one of four classes per power of two, so a recycled buffer
+// wastes at most 25% and nearby sizes (e.g. padded rows) still share a class.
+size_t BufferPool::sizeClass(size_t bytes) {
+    if (bytes < kMinPooledBytes)
+        return bytes;
+    size_t power = 1;
+    while (power <= bytes / 2)
+        power <<= 1;
+    size_t step = power / 4;
+    return (bytes + step - 1) / step * step;
+}
+
+cv::UMatData* BufferPool::allocate(int dims, const int* sizes, int type, void* data0, size_t* step,
+                                   cv::AccessFlag /*flags*/, cv::UMatUsageFlags /*usageFlags*/) const {
+    // Same layout rules as OpenCV's standard allocator
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+        if (step) {
+            if (data0 && step[i] != cv::Mat::AUTO_STEP) {
+                CV_Assert(total <= step[i]);
+                total = step[i];
+            } else {
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+
+    cv::UMatData* u = new cv::UMatData(this);
+    u->data = u->origdata = data0 ? static_cast<uchar*>(data0) : acquire(total);
+    u->size = total;
+    if (data0)
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+    return u;
+}
+
+bool BufferPool::allocate(cv::UMatData* u, cv::AccessFlag, cv::UMatUsageFlags) const {
+    return u != nullptr;
+}
+
+void BufferPool::deallocate(cv::UMatData* u) const {
+    if (!u)
+        return;
+    CV_Assert(u->urefcount == 0);
+    CV_Assert(u->refcount == 0);
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+        recycle(u->origdata, u->size);
+        u->origdata = nullptr;
+    }
+    delete u;
+}
+
+uchar* BufferPool::acquire(size_t bytes) const {
+    size_t cls = sizeClass(bytes);
+    if (cls < kMinPooledBytes)
+        return static_cast<uchar*>(cv::fastMalloc(bytes));
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.requests;
+        auto it = freeBlocks.find(cls);
+        if (it != freeBlocks.end()) {
+            uchar* data = it->second.data;
+            freeBlocks.erase(it);
+            ++stats.hits;
+            stats.bytesCached -= cls;
+            stats.bytesInUse += cls;
+            return data;
+        }
+    }
+
+    // Miss: allocate outside the lock, the OS call can be slow for big buffers
+    uchar* data = static_cast<uchar*>(cv::fastMalloc(cls));
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.bytesInUse += cls;
+    stats.peakBytes = std::max(stats.peakBytes, stats.bytesInUse + stats.bytesCached);
+    return data;
+}
+
+void BufferPool::recycle(uchar* data, size_t bytes) const {
+    if (!data)
+        return;
+    size_t cls = sizeClass(bytes);
+    if (cls < kMinPooledBytes) {
+        cv::fastFree(data);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.bytesInUse -= cls;
+    if (cls > maxCachedBytes) {
+        cv::fastFree(data);
+        return;
+    }
+    freeBlocks.insert({ cls, Block{ data, ++clock } });
+    stats.bytesCached += cls;
+    evictLocked();
+}
+
+// Drops the least recently freed buffers until the cache fits the limit
+void BufferPool::evictLocked() const {
+    while (stats.bytesCached > maxCachedBytes && !freeBlocks.empty()) {
+        auto oldest = freeBlocks.begin();
+        for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it) {
+            if (it->second.freedAt < oldest->second.freedAt)
+                oldest = it;
+        }
+        cv::fastFree(oldest->second.data);
+        stats.bytesCached -= oldest->first;
+        freeBlocks.erase(oldest);
+    }
+}
+
+void BufferPool::trim() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& entry : freeBlocks)
+        cv::fastFree(entry.second.data);
+    freeBlocks.clear();
+    stats.bytesCached = 0;
+}
+
+BufferPool::Stats BufferPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+// Recycling allocator for image buffers.
+//
+// Installed as OpenCV's default cv::MatAllocator, so every cv::Mat the nodes
+// create (outputs and temporaries alike) draws from it. Freed buffers are kept
+// in size classes (four per power of two) and handed back to the next
+// allocation of the same class instead of going back to the OS, which avoids
+// re-faulting fresh pages for large images on every evaluation. Small
+// allocations bypass the pool. The cache is bounded; when it grows past the
+// limit the least recently freed buffers are released.
+class BufferPool : public cv::MatAllocator {
+public:
+    struct Stats {
+        uint64_t requests = 0;   // Pooled-size allocations
+        uint64_t hits = 0;       // ... served from the cache
+        size_t bytesInUse = 0;   // Handed out and not yet freed
+        size_t bytesCached = 0;  // Held in the free lists
+        size_t peakBytes = 0;    // Highest bytesInUse + bytesCached seen
+
+        double hitRate() const { return requests ? double(hits) / double(requests) : 0.0; }
+    };
+
+    // Process-wide pool. Never destroyed, since static Mats may release
+    // their buffers after main() returns.
+    static BufferPool& instance();
+
+    // Makes the pool OpenCV's default allocator for new Mats
+    static void install();
+
+    explicit BufferPool(size_t maxCachedBytes = size_t(1) << 30);
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override;
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags,
+                  cv::UMatUsageFlags usageFlags) const override;
+    void deallocate(cv::UMatData* data) const override;
+
+    Stats getStats() const;
+
+    // Frees every cached buffer (e.g. after the working image size changed)
+    void trim();
+
+    // Buffers below this size go straight to cv::fastMalloc
+    static const size_t kMinPooledBytes = 64 * 1024;
+
+private:
+    struct Block {
+        uchar* data;
+        uint64_t freedAt;
+    };
+
+    static size_t sizeClass(size_t bytes);
+    uchar* acquire(size_t bytes) const;
+    void recycle(uchar* data, size_t bytes) const;
+    void evictLocked() const;
+
+    // Allocator callbacks are const in the cv::MatAllocator interface
+    mutable std::mutex mutex;
+    mutable std::multimap<size_t, Block> freeBlocks; // Keyed by size class
+    mutable Stats stats;
+    mutable uint64_t clock = 0;
+    size_t maxCachedBytes;
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include <atomic>
+
+// Cooperative cancellation of an evaluation in progress.
+//
+// The owner of an evaluation (PipelineEvaluator) raises the flag when newer
+// changes make the running pass pointless; long-running nodes and tiled
+// chains poll it between rows, bands or tiles and stop early. Checking is one
+// relaxed load. A cancelled pass publishes nothing and leaves the unfinished
+// nodes dirty, so the next pass recomputes them.
+class CancelToken {
+public:
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    void reset() { cancelled.store(false, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelled{false};
+};
@@ -1,57 +1,56 @@
 #include "ColorChannelSplitterNode.h"
-#include <imgui.h>
 #include <opencv2/imgproc.hpp>
 
 void ColorChannelSplitterNode::process() {
     if (inputImage.empty()) {
         return; // No input image to process
     }
-    if (dirty) {
-        std::vector<cv::Mat> channels;
-        cv::split(inputImage, channels);
-    
-        if (channels.size() >= 3) {
-            // std::cout << "ColorChannelSplitterNode::process(): Splitting channels" << std::endl;
-            redChannel = channels[2];
-            greenChannel = channels[1];
-            blueChannel = channels[0];
-        }
-    
-        // Create a blank image for merging
-        cv::Mat blank = cv::Mat::zeros(redChannel.size(), redChannel.type());
-    
-        // Merge selected channels into a 3-channel BGR image
-        std::vector<cv::Mat> mergedChannels = {
-            showBlue ? blueChannel : blank,
-            showGreen ? greenChannel : blank,
-            showRed ? redChannel : blank
-        };
-    
-        cv::merge(mergedChannels, outputImage);
-    
-        dirty = false;
+    // Snapshot parameters; the UI may edit them while we compute
+    bool red, green, blue;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        red = showRed;
+        green = showGreen;
+        blue = showBlue;
     }
-    
-}
 
-void ColorChannelSplitterNode::drawUI() {
-    ImGui::Text("Color Channel Splitter Node");
-    bool updated = false;
-    updated |= ImGui::Checkbox("Show Red Channel", &showRed);
-    updated |= ImGui::Checkbox("Show Green Channel", &showGreen);
-    updated |= ImGui::Checkbox("Show Blue Channel", &showBlue);
-    
-    if (updated) {
-        dirty = true;
+    std::vector<cv::Mat> channels;
+    cv::split(inputImage, channels);
+    if (channels.size() < 3) {
+        return; // Needs a color input
     }
+    // std::cout << "ColorChannelSplitterNode::process(): Splitting channels" << std::endl;
 
-    if (outputImage.empty()) {
-        ImGui::Text("No output image available.");
-    } else {
-        ImGui::Text("Output image is ready.");
-    }
-    if (ImGui::Button("Reset")) {
-        reset(); // Call the reset method
-    }
+    // Create a blank image for merging
+    cv::Mat blank = cv::Mat::zeros(channels[2].size(), channels[2].type());
+
+    // Merge selected channels into a 3-channel BGR image
+    std::vector<cv::Mat> mergedChannels = {
+        blue ? channels[0] : blank,
+        green ? channels[1] : blank,
+        red ? channels[2] : blank
+    };
+
+    cv::Mat result;
+    cv::merge(mergedChannels, result);
 
-}
\ No newline at end of file
+    std::lock_guard<std::mutex> lock(stateMutex);
+    redChannel = channels[2];
+    greenChannel = channels[1];
+    blueChannel = channels[0];
+    outputImage = result;
+}
+
+bool ColorChannelSplitterNode::getPointOps(std::vector<PointOp>& ops) const {
+    // Output 0 only: hidden channels map to zero (BGR order)
+    PointOp op;
+    op.channels = 3;
+    op.tables.resize(3);
+    bool keep[3] = { showBlue, showGreen, showRed };
+    for (int c = 0; c < 3; ++c) {
+        for (int v = 0; v < 256; ++v)
+            op.tables[c][v] = keep[c] ? static_cast<uchar>(v) : 0;
+    }
+    ops.push_back(op);
+    return true;
+}
@@ -5,33 +5,60 @@
 
 class ColorChannelSplitterNode : public NodeBase {
 public:
-    ColorChannelSplitterNode() : NodeBase("ColorChannelSplitter") {}
+    ColorChannelSplitterNode() : NodeBase("ColorChannelSplitter") {
+        addChannelPorts();
+    }
 
     // Constructor to accept BrightnessContrastNode
     ColorChannelSplitterNode(BrightnessContrastNode& bcNode)
-        : NodeBase("ColorChannelSplitter"), brightnessContrastNode(&bcNode) {}
+        : NodeBase("ColorChannelSplitter"), brightnessContrastNode(&bcNode) {
+        addChannelPorts();
+    }
+
+    // Output 0 is the merged image, outputs 1-3 the individual channels
+    void addChannelPorts() {
+        outputPorts = { { "Image" },
+                        { "Red", PortType::Gray },
+                        { "Green", PortType::Gray },
+                        { "Blue", PortType::Gray } };
+    }
 
     void process();
-    void drawUI();
+    const char* getTypeName() const override { return "ColorChannelSplitter"; }
+    void visitParams(ParamVisitor& v) override {
+        v.visit("showRed", showRed);
+        v.visit("showGreen", showGreen);
+        v.visit("showBlue", showBlue);
+    }
+    bool getPointOps(std::vector<PointOp>& ops) const override;
+    bool getInputRegion(int, const cv::Rect& outputRegion, cv::Rect& inputRegion) const override {
+        inputRegion = outputRegion; // Point-wise
+        return true;
+    }
 
     void setInputImage(const cv::Mat& image) {
         inputImage = image;
-        dirty = true; // Mark the node as needing processing
     }
 
     const cv::Mat& getOutputImage() const {
         return outputImage;
     }
 
-    cv::Mat inputImage;
-    cv::Mat outputImage;
+    const cv::Mat& getOutput(int port) const override {
+        switch (port) {
+            case 1: return redChannel;
+            case 2: return greenChannel;
+            case 3: return blueChannel;
+            default: return outputImage;
+        }
+    }
+
     cv::Mat redChannel;
     cv::Mat greenChannel;
     cv::Mat blueChannel;
     bool showRed = true;  // Default to true
     bool showGreen = true; // Default to true
     bool showBlue = true;  // Default to true
-    bool dirty = false;
     void reset() override {
         NodeBase::reset(); // Call base class reset
         showRed = true;
@@ -1,9 +1,34 @@
 #include "ConvolutionFilterNode.h"
-#include <imgui.h>
+#include "PresetKernels.h"
 #include <opencv2/imgproc.hpp>
 #include <iostream>
 #include <algorithm>
 
+namespace {
+
+template <class K>
+ConvolutionPlan::IntegerKernel ifMatches(const std::vector<float>& kernel) {
+    return PresetKernels::matches<K>(kernel) ? PresetKernels::convolve<K> : nullptr;
+}
+
+// Specialized 8-bit kernel for a preset, or nullptr if there is none. The
+// coefficients are checked too, in case the kernel was edited after loading.
+ConvolutionPlan::IntegerKernel integerKernel(KernelPreset preset, const std::vector<float>& kernel) {
+    using namespace PresetKernels;
+    switch (preset) {
+        case KernelPreset::Sharpen:
+            return kernel.size() == 9 ? ifMatches<Sharpen3>(kernel) : ifMatches<Sharpen5>(kernel);
+        case KernelPreset::Emboss:
+            return kernel.size() == 9 ? ifMatches<Emboss3>(kernel) : ifMatches<Emboss5>(kernel);
+        case KernelPreset::EdgeEnhance:
+            return kernel.size() == 9 ? ifMatches<EdgeEnhance3>(kernel) : ifMatches<EdgeEnhance5>(kernel);
+        default:
+            return nullptr;
+    }
+}
+
+} // namespace
+
 ConvolutionFilterNode::ConvolutionFilterNode()
     : NodeBase("Convolution Filter Node"),
       useFilter(false),        // Default: filter is disabled, so original image will pass through
@@ -15,8 +40,7 @@ ConvolutionFilterNode::ConvolutionFilterNode()
 }
 
 void ConvolutionFilterNode::setInputImage(const cv::Mat& image) {
-    inputImage = image.clone();
-    dirty = true;
+    inputImage = image;
 }
 
 const cv::Mat& ConvolutionFilterNode::getOutputImage() const {
@@ -30,21 +54,15 @@ void ConvolutionFilterNode::updateKernelPreset() {
         switch (kernelPreset) {
             case KernelPreset::Sharpen:
                 // Sharpen 3x3 kernel
-                customKernel = {  0, -1,  0,
-                                 -1,  5, -1,
-                                  0, -1,  0 };
+                customKernel = PresetKernels::coefficients<PresetKernels::Sharpen3>();
                 break;
             case KernelPreset::Emboss:
                 // Emboss 3x3 kernel
-                customKernel = { -2, -1,  0,
-                                 -1,  1,  1,
-                                  0,  1,  2 };
+                customKernel = PresetKernels::coefficients<PresetKernels::Emboss3>();
                 break;
             case KernelPreset::EdgeEnhance:
                 // Edge enhance 3x3 kernel
-                customKernel = {  1,  1,  1,
-                                  1, -7,  1,
-                                  1,  1,  1 };
+                customKernel = PresetKernels::coefficients<PresetKernels::EdgeEnhance3>();
                 break;
             case KernelPreset::Custom:
             default:
@@ -59,33 +77,15 @@ void ConvolutionFilterNode::updateKernelPreset() {
         switch (kernelPreset) {
             case KernelPreset::Sharpen:
                 // Example 5x5 sharpen kernel
-                customKernel = {
-                    -1, -1, -1, -1, -1,
-                    -1,  2,  2,  2, -1,
-                    -1,  2,  8,  2, -1,
-                    -1,  2,  2,  2, -1,
-                    -1, -1, -1, -1, -1
-                };
+                customKernel = PresetKernels::coefficients<PresetKernels::Sharpen5>();
                 break;
             case KernelPreset::Emboss:
                 // Simple 5x5 emboss kernel
-                customKernel = {
-                    -2, -1,  0,  1,  2,
-                    -2, -1,  0,  1,  2,
-                    -2, -1,  0,  1,  2,
-                    -2, -1,  0,  1,  2,
-                    -2, -1,  0,  1,  2
-                };
+                customKernel = PresetKernels::coefficients<PresetKernels::Emboss5>();
                 break;
             case KernelPreset::EdgeEnhance:
                 // Example 5x5 edge enhance kernel
-                customKernel = {
-                     1,  1,   1,  1,  1,
-                     1,  1,   1,  1,  1,
-                     1,  1, -24,  1,  1,
-                     1,  1,   1,  1,  1,
-                     1,  1,   1,  1,  1
-                };
+                customKernel = PresetKernels::coefficients<PresetKernels::EdgeEnhance5>();
                 break;
             case KernelPreset::Custom:
             default:
@@ -94,89 +94,111 @@ void ConvolutionFilterNode::updateKernelPreset() {
                 customKernel[12] = 1.0f;
                 break;
         }
+    } else {
+        // Other sizes: the same filters grown to the kernel size, scaled to
+        // the 5x5 versions' strength
+        int n = kernelSize, c = n / 2;
+        customKernel.assign(n * n, 0.0f);
+        if (n == 1) {
+            customKernel[0] = 1.0f;
+            return;
+        }
+        switch (kernelPreset) {
+            case KernelPreset::Sharpen:
+                // Twice the image minus its local mean
+                for (float& v : customKernel)
+                    v = -1.0f / (n * n);
+                customKernel[c * n + c] += 2.0f;
+                break;
+            case KernelPreset::Emboss:
+                // Horizontal ramp
+                for (int y = 0; y < n; ++y)
+                    for (int x = 0; x < n; ++x)
+                        customKernel[y * n + x] = 2.0f * (x - c) / c;
+                break;
+            case KernelPreset::EdgeEnhance:
+                // Centre minus its surroundings
+                for (float& v : customKernel)
+                    v = 24.0f / (n * n - 1);
+                customKernel[c * n + c] = -24.0f;
+                break;
+            case KernelPreset::Custom:
+            default:
+                customKernel[c * n + c] = 1.0f;
+                break;
+        }
     }
 }
 
 void ConvolutionFilterNode::process() {
-    if (!dirty) return;
     if (inputImage.empty()) {
         std::cerr << "ConvolutionFilterNode::process() - input image is empty\n";
-        dirty = false;
         return;
     }
     
+    // Snapshot parameters; the UI may edit them while we compute
+    bool enabled;
+    std::shared_ptr<const ConvolutionPlan> kernelPlan;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        // Ensure the customKernel has the correct size.
+        if (customKernel.size() != static_cast<size_t>(kernelSize * kernelSize)) {
+            updateKernelPreset();
+        }
+        enabled = useFilter;
+        if (enabled)
+            kernelPlan = getPlan(customKernel, kernelSize);
+    }
+
     // If filtering is not enabled, pass the input image through unchanged.
-    if (!useFilter) {
-        outputImage = inputImage.clone();
-        dirty = false;
+    if (!enabled) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        outputImage = inputImage; // Shared, not copied
         return;
     }
     
-    // Ensure the customKernel has the correct size.
-    if (customKernel.size() != static_cast<size_t>(kernelSize * kernelSize)) {
-        updateKernelPreset();
-    }
-    
-    // Create an OpenCV kernel from customKernel data.
-    cv::Mat kernelMat(kernelSize, kernelSize, CV_32F, customKernel.data());
-    
-    // Apply the convolution filter using OpenCV's filter2D.
-    cv::filter2D(inputImage, outputImage, -1, kernelMat);
-    dirty = false;
+    // Apply the planned convolution in bands of rows so a superseded
+    // evaluation stops early. Each band reads its neighbours' rows through
+    // the ROI, so the result matches a single full-frame call.
+    cv::Mat result(inputImage.size(), inputImage.type());
+    bool finished = forEachBand(inputImage.rows, kernelPlan->getBandRows(), [&](const cv::Range& rows) {
+        cv::Mat band = result.rowRange(rows);
+        kernelPlan->apply(inputImage.rowRange(rows), band);
+    });
+    if (!finished)
+        return;
+
+    std::lock_guard<std::mutex> lock(stateMutex);
+    outputImage = result;
 }
 
-void ConvolutionFilterNode::drawUI() {
-    ImGui::Text("Convolution Filter Node");
-    bool changed = false;
-    
-    // Checkbox for enabling/disabling filter (if disabled, original image shows)
-    changed |= ImGui::Checkbox("Enable Filter", &useFilter);
-    
-    // Kernel size selection with radio buttons (3x3 vs 5x5)
-    int radioChoice = (kernelSize == 3) ? 0 : 1;
-    if (ImGui::RadioButton("3x3", &radioChoice, 0)) {
-        kernelSize = 3;
-        changed = true;
-    }
-    ImGui::SameLine();
-    if (ImGui::RadioButton("5x5", &radioChoice, 1)) {
-        kernelSize = 5;
-        changed = true;
-    }
-    
-    // Kernel preset selection combo
-    const char* presets[] = { "Custom", "Sharpen", "Emboss", "Edge Enhance" };
-    int presetIdx = static_cast<int>(kernelPreset);
-    if (ImGui::Combo("Preset", &presetIdx, presets, IM_ARRAYSIZE(presets))) {
-        kernelPreset = static_cast<KernelPreset>(presetIdx);
-        updateKernelPreset();
-        changed = true;
-    }
-    
-    // Allow manual editing only in Custom preset mode
-    if (kernelPreset == KernelPreset::Custom) {
-        int totalElements = kernelSize * kernelSize;
-        for (int i = 0; i < totalElements; ++i) {
-            std::string label = "K" + std::to_string(i);
-            changed |= ImGui::InputFloat(label.c_str(), &customKernel[i], 0.1f, 1.0f, "%.2f");
-            if ((i + 1) % kernelSize != 0)
-                ImGui::SameLine();
-        }
-    } else {
-        ImGui::Text("Switch to 'Custom' preset to edit kernel values manually.");
-    }
-    
-    if (changed) {
-        dirty = true;
-    }
-    
-    if (!inputImage.empty()) {
-        process();
-        ImGui::Text("Kernel Effect Preview:");
-        // Note: Typically, here you would convert outputImage to a texture and display it.
-        // This framework-specific code is assumed to be handled elsewhere in your system.
-    }
-    if (ImGui::Button("Reset")) {
-        reset(); // Call the reset method
+bool ConvolutionFilterNode::getTileKernel(TileKernel& kernel) const {
+    if (customKernel.size() != static_cast<size_t>(kernelSize * kernelSize))
+        return false; // Preset not rebuilt yet; process() fixes it up
+
+    // The plan holds its own copy of the coefficients, the UI may edit
+    // customKernel meanwhile
+    std::shared_ptr<const ConvolutionPlan> kernelPlan = getPlan(customKernel, kernelSize);
+    kernel.halo = kernelSize / 2;
+    kernel.apply = [kernelPlan](const cv::Mat& src, const cv::Rect&, cv::Mat& dst) {
+        kernelPlan->apply(src, dst);
+    };
+    return true;
+}
+
+std::shared_ptr<const ConvolutionPlan> ConvolutionFilterNode::getPlan(const std::vector<float>& kernel, int size) const {
+    if (!plan || kernel != plannedKernel || kernelPreset != plannedPreset) {
+        std::vector<float> coefficients = kernel;
+        plan = std::make_shared<ConvolutionPlan>(cv::Mat(size, size, CV_32F, coefficients.data()),
+                                                 integerKernel(kernelPreset, kernel));
+        plannedKernel = kernel;
+        plannedPreset = kernelPreset;
     }
+    return plan;
+}
+
+bool ConvolutionFilterNode::getInputRegion(int, const cv::Rect& outputRegion, cv::Rect& inputRegion) const {
+    int reach = useFilter ? kernelSize / 2 : 0;
+    inputRegion = growRegion(outputRegion, reach, reach);
+    return true;
 }
@@ -1,6 +1,8 @@
 #pragma once
+#include "ConvolutionPlan.h"
 #include "NodeBase.h"
 #include <opencv2/core.hpp>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -11,29 +13,54 @@ enum class KernelPreset {
     EdgeEnhance
 };
 
+// Convolves the image with an odd-sized square kernel, from a preset or
+// edited by hand. How the kernel runs (separable passes, dense, FFT) is
+// planned per kernel by ConvolutionPlan.
 class ConvolutionFilterNode : public NodeBase {
 public:
+    static constexpr int kMaxKernelSize = 63;
+
     ConvolutionFilterNode();
 
     void setInputImage(const cv::Mat& image) ;
     const cv::Mat& getOutputImage() const;
     void process() override;
-    void drawUI() override;
+    const char* getTypeName() const override { return "ConvolutionFilter"; }
+    void visitParams(ParamVisitor& v) override {
+        v.visit("enabled", useFilter);
+        v.visit("kernelSize", kernelSize);
+        v.visit("preset", kernelPreset);
+        v.visit("kernel", customKernel);
+        if (kernelSize < 1 || kernelSize > kMaxKernelSize || kernelSize % 2 == 0)
+            kernelSize = 3;
+        clampParam(kernelPreset, KernelPreset::Custom, KernelPreset::EdgeEnhance);
+        if (kernelPreset != KernelPreset::Custom)
+            updateKernelPreset(); // Presets define the kernel
+    }
+    bool isPassThrough() const override { return !useFilter; }
+    bool getTileKernel(TileKernel& kernel) const override;
+    bool getInputRegion(int port, const cv::Rect& outputRegion, cv::Rect& inputRegion) const override;
 
     // All members are public for ease of access
-    cv::Mat inputImage;
-    cv::Mat outputImage;
-
     // Toggle for enabling/disabling filter processing
     bool useFilter;
 
     // Kernel configuration
-    int kernelSize;             // Either 3 (3x3) or 5 (5x5)
+    int kernelSize;             // Odd, 1 to kMaxKernelSize
     KernelPreset kernelPreset;  // Chosen preset
     std::vector<float> customKernel; // Kernel matrix (row-major order)
 
     // Utility function to update customKernel based on selected preset and kernel size
     void updateKernelPreset();
+
+    // Plan for the given kernel, reused while the kernel and preset stay the
+    // same. Called with stateMutex held.
+    std::shared_ptr<const ConvolutionPlan> getPlan(const std::vector<float>& kernel, int size) const;
+
+    // Plan of the last run, shown in the UI (guarded by stateMutex)
+    mutable std::shared_ptr<const ConvolutionPlan> plan;
+    mutable std::vector<float> plannedKernel;
+    mutable KernelPreset plannedPreset = KernelPreset::Custom;
     void reset() override {
         NodeBase::reset(); // Call base class reset
         useFilter = false; // Reset filter to disabled state
@@ -0,0 +1,192 @@
+#include "ConvolutionPlan.h"
+#include "Profiler.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Relative cost of one FFT butterfly operation against one vectorized
+// multiply-add of the direct filter: complex arithmetic, strided access
+constexpr double kFftWeight = 3.0;
+
+double directCost(int size) {
+    return static_cast<double>(size) * size;
+}
+
+// A row and a column pass per term; several terms also accumulate in float
+double separableCost(int size, int rank) {
+    return rank * 2.0 * size + (rank > 1 ? rank * 2.0 : 0.0);
+}
+
+// Edge of the square FFT blocks: several kernels wide so the halo each block
+// rereads stays small, at a size the FFT handles fast
+int fftBlockSize(int size) {
+    return cv::getOptimalDFTSize(std::max(64, 4 * size));
+}
+
+// Forward and inverse transform of a block plus the spectrum product, spread
+// over the block's valid outputs
+double fftCost(int size) {
+    double block = fftBlockSize(size);
+    double valid = block - size + 1;
+    return kFftWeight * (2.0 * std::log2(block * block) + 4.0) * block * block / (valid * valid);
+}
+
+} // namespace
+
+ConvolutionPlan::ConvolutionPlan(const cv::Mat& k, IntegerKernel integer)
+    : integerKernel(integer) {
+    CV_Assert(k.type() == CV_32F && k.rows == k.cols && k.rows % 2 == 1);
+    kernel = k.clone();
+    int size = kernel.rows;
+
+    estimatedCost = directCost(size);
+    if (fftCost(size) < estimatedCost) {
+        strategy = Fft;
+        estimatedCost = fftCost(size);
+        blockSize = fftBlockSize(size);
+    }
+
+    // Fewest separable terms that reproduce the kernel within tolerance,
+    // as long as they beat the dense strategies
+    cv::Mat k64, w, u, vt;
+    kernel.convertTo(k64, CV_64F);
+    cv::SVD::compute(k64, w, u, vt);
+    cv::Mat approx = cv::Mat::zeros(size, size, CV_64F);
+    for (int rank = 1; rank <= size && separableCost(size, rank) < estimatedCost; ++rank) {
+        approx += w.at<double>(rank - 1) * u.col(rank - 1) * vt.row(rank - 1);
+        double residual = cv::norm(k64, approx, cv::NORM_L1);
+        if (residual > kTolerance)
+            continue;
+
+        for (int i = 0; i < rank; ++i) {
+            double s = std::sqrt(w.at<double>(i));
+            cv::Mat column, row;
+            cv::Mat(u.col(i) * s).convertTo(column, CV_32F);
+            cv::Mat(vt.row(i) * s).convertTo(row, CV_32F);
+            columnKernels.push_back(column);
+            rowKernels.push_back(row);
+        }
+        strategy = rank == 1 ? Separable : LowRank;
+        error = residual;
+        estimatedCost = separableCost(size, rank);
+        blockSize = 0;
+        break;
+    }
+}
+
+const char* ConvolutionPlan::getStrategyName() const {
+    switch (strategy) {
+        case Direct: return "Direct";
+        case Separable: return "Separable";
+        case LowRank: return "Low rank";
+        case Fft: return "FFT";
+    }
+    return "";
+}
+
+int ConvolutionPlan::getBandRows() const {
+    return strategy == Fft ? blockSize - kernel.rows + 1 : 64;
+}
+
+double ConvolutionPlan::getMeasuredNsPerPixel() const {
+    uint64_t pixels = measuredPixels.load(std::memory_order_relaxed);
+    return pixels ? static_cast<double>(measuredNs.load(std::memory_order_relaxed)) / pixels : 0.0;
+}
+
+void ConvolutionPlan::apply(const cv::Mat& src, cv::Mat& dst) const {
+    uint64_t start = Profiler::now();
+    if (integerKernel && src.depth() == CV_8U) {
+        integerKernel(src, dst);
+        measuredNs.fetch_add(Profiler::now() - start, std::memory_order_relaxed);
+        measuredPixels.fetch_add(src.total(), std::memory_order_relaxed);
+        return;
+    }
+    switch (strategy) {
+        case Direct:
+            cv::filter2D(src, dst, -1, kernel);
+            break;
+        case Separable:
+            cv::sepFilter2D(src, dst, -1, rowKernels[0], columnKernels[0]);
+            break;
+        case LowRank: {
+            // Terms summed in float, rounded once at the end
+            cv::Mat sum, term;
+            cv::sepFilter2D(src, sum, CV_32F, rowKernels[0], columnKernels[0]);
+            for (size_t i = 1; i < rowKernels.size(); ++i) {
+                cv::sepFilter2D(src, term, CV_32F, rowKernels[i], columnKernels[i]);
+                sum += term;
+            }
+            sum.convertTo(dst, src.type());
+            break;
+        }
+        case Fft:
+            applyFft(src, dst);
+            break;
+    }
+    measuredNs.fetch_add(Profiler::now() - start, std::memory_order_relaxed);
+    measuredPixels.fetch_add(src.total(), std::memory_order_relaxed);
+}
+
+cv::Mat ConvolutionPlan::getKernelSpectrum(cv::Size block) const {
+    std::lock_guard<std::mutex> lock(spectrumMutex);
+    for (const auto& cached : kernelSpectra) {
+        if (cached.first == block)
+            return cached.second;
+    }
+
+    // Correlation is convolution with the flipped kernel
+    int size = kernel.rows;
+    cv::Mat kernelBlock = cv::Mat::zeros(block, CV_32F), spectrum;
+    cv::Mat flipped = kernelBlock(cv::Rect(0, 0, size, size));
+    cv::flip(kernel, flipped, -1);
+    cv::dft(kernelBlock, spectrum, 0, size);
+    kernelSpectra.push_back({ block, spectrum });
+    return spectrum;
+}
+
+// Overlap-save: each block of input, halo included, is transformed, multiplied
+// by the kernel's spectrum and transformed back; the outputs not wrapped
+// around by the circular convolution are exactly that block's result.
+void ConvolutionPlan::applyFft(const cv::Mat& src, cv::Mat& dst) const {
+    int size = kernel.rows, halo = size / 2;
+
+    // Like filter2D, uses the parent image's pixels around an ROI and
+    // reflects beyond the image's edges
+    cv::Mat padded;
+    cv::copyMakeBorder(src, padded, halo, halo, halo, halo, cv::BORDER_REFLECT_101);
+
+    // Blocks no larger than the image needs
+    int blockRows = std::min(blockSize, cv::getOptimalDFTSize(src.rows + size - 1));
+    int blockCols = std::min(blockSize, cv::getOptimalDFTSize(src.cols + size - 1));
+    int validRows = blockRows - size + 1, validCols = blockCols - size + 1;
+
+    cv::Mat kernelSpectrum = getKernelSpectrum(cv::Size(blockCols, blockRows));
+
+    std::vector<cv::Mat> planes, results(padded.channels());
+    cv::split(padded, planes);
+    cv::Mat block(blockRows, blockCols, CV_32F), spectrum, filtered;
+    for (size_t c = 0; c < planes.size(); ++c) {
+        results[c].create(src.size(), CV_32F);
+        for (int y = 0; y < src.rows; y += validRows) {
+            for (int x = 0; x < src.cols; x += validCols) {
+                int rows = std::min(validRows, src.rows - y), cols = std::min(validCols, src.cols - x);
+                cv::Rect input(x, y, cols + size - 1, rows + size - 1);
+                block.setTo(0);
+                cv::Mat area = block(cv::Rect(cv::Point(), input.size()));
+                planes[c](input).convertTo(area, CV_32F);
+
+                cv::dft(block, spectrum, 0, input.height);
+                cv::mulSpectrums(spectrum, kernelSpectrum, spectrum, 0);
+                cv::idft(spectrum, filtered, cv::DFT_SCALE | cv::DFT_REAL_OUTPUT, input.height);
+                cv::Mat out = results[c](cv::Rect(x, y, cols, rows));
+                filtered(cv::Rect(size - 1, size - 1, cols, rows)).copyTo(out);
+            }
+        }
+    }
+
+    cv::Mat merged;
+    cv::merge(results, merged);
+    merged.convertTo(dst, src.type());
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Cheapest way to run one convolution kernel (see ConvolutionFilterNode).
+//
+// The kernel is factored by SVD into separable terms (a column times a row).
+// If one term reproduces it within kTolerance it runs as a single separable
+// pass, 2k instead of k*k multiply-adds per pixel; if a few terms do, as a
+// sum of separable passes. Otherwise it runs dense: directly (cv::filter2D,
+// vectorized) for small kernels, or through the FFT for large ones, in
+// overlap-save blocks so the transforms stay small. The strategy with the
+// lowest estimated cost per pixel wins. Kernels with a hand-written integer
+// form (PresetKernels) use that for 8-bit images instead; it's exact and
+// beats every float strategy.
+//
+// Every strategy computes what cv::filter2D does (correlation, centred
+// anchor, BORDER_REFLECT_101) and, like it, reads the parent image's pixels
+// around an ROI input, so results don't depend on how the image is split
+// into bands or tiles. apply() is const and may run on many threads.
+class ConvolutionPlan {
+public:
+    enum Strategy { Direct, Separable, LowRank, Fft };
+
+    // Exact 8-bit convolution specialized for one kernel (PresetKernels::convolve)
+    typedef void (*IntegerKernel)(const cv::Mat& src, cv::Mat& dst);
+
+    // Largest sum of |kernel - approximation| the separable strategies may
+    // leave: no output moves by more than half an 8-bit level
+    static constexpr double kTolerance = 0.5 / 255.0;
+
+    // Plans a square CV_32F kernel of odd size. 'integerKernel', if given,
+    // must compute the same kernel; it then runs all 8-bit images.
+    explicit ConvolutionPlan(const cv::Mat& kernel, IntegerKernel integerKernel = nullptr);
+
+    // Convolves src into dst, which gets src's size and type
+    void apply(const cv::Mat& src, cv::Mat& dst) const;
+
+    Strategy getStrategy() const { return strategy; } // For images other than 8-bit if hasIntegerKernel()
+    bool hasIntegerKernel() const { return integerKernel != nullptr; }
+    const char* getStrategyName() const;
+    int getRank() const { return static_cast<int>(rowKernels.size()); } // Separable terms used
+    double getError() const { return error; }                           // Sum of |kernel - approximation|
+    double getEstimatedCost() const { return estimatedCost; }           // Weighted multiply-adds per pixel and channel
+    int getBlockSize() const { return blockSize; }                      // FFT block edge
+
+    // Rows per band that suit the strategy, e.g. one row of FFT blocks
+    int getBandRows() const;
+
+    // Average time per output pixel over all apply() calls so far, 0 before the first
+    double getMeasuredNsPerPixel() const;
+
+private:
+    void applyFft(const cv::Mat& src, cv::Mat& dst) const;
+
+    // Spectrum of the flipped kernel padded to 'block', computed on first use
+    // per block shape (bands and tiles share a few) and kept
+    cv::Mat getKernelSpectrum(cv::Size block) const;
+
+    cv::Mat kernel;
+    Strategy strategy = Direct;
+    IntegerKernel integerKernel = nullptr;
+    std::vector<cv::Mat> rowKernels;    // Separable terms, row (horizontal) parts
+    std::vector<cv::Mat> columnKernels; // and column (vertical) parts
+    double error = 0.0;
+    double estimatedCost = 0.0;
+    int blockSize = 0;
+
+    mutable std::mutex spectrumMutex; // Guards kernelSpectra
+    mutable std::vector<std::pair<cv::Size, cv::Mat>> kernelSpectra;
+
+    mutable std::atomic<uint64_t> measuredNs{0};
+    mutable std::atomic<uint64_t> measuredPixels{0};
+};
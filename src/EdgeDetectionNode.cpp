@@ -1,6 +1,6 @@
 #include "EdgeDetectionNode.h"
-#include <imgui.h>
 #include <opencv2/imgproc.hpp>
+#include <algorithm>
 #include <iostream>
 
 EdgeDetectionNode::EdgeDetectionNode()
@@ -14,13 +14,12 @@ EdgeDetectionNode::EdgeDetectionNode()
 }
 
 void EdgeDetectionNode::setInputImage(const cv::Mat& image) {
-    inputImage = image.clone();
+    inputImage = image;
     if (!inputImage.empty() && inputImage.channels() == 3) {
         cv::cvtColor(inputImage, grayImage, cv::COLOR_BGR2GRAY);
     } else {
-        grayImage = inputImage.clone();
+        grayImage = inputImage; // Already gray: share
     }
-    dirty = true;
 }
 
 const cv::Mat& EdgeDetectionNode::getOutputImage() const {
@@ -28,70 +27,86 @@ const cv::Mat& EdgeDetectionNode::getOutputImage() const {
 }
 
 void EdgeDetectionNode::process() {
-    if (!dirty) return;
-
     if (grayImage.empty()) {
         std::cerr << "EdgeDetectionNode::process() - input is empty\n";
+        std::lock_guard<std::mutex> lock(stateMutex);
         outputImage = cv::Mat();
-        dirty = false;
         return;
     }
 
-    if (method == EdgeMethod::Sobel) {
-        cv::Mat gradX, gradY;
-        cv::Sobel(grayImage, gradX, CV_16S, 1, 0, sobelKernelSize);
-        cv::Sobel(grayImage, gradY, CV_16S, 0, 1, sobelKernelSize);
-
-        cv::Mat absX, absY;
-        cv::convertScaleAbs(gradX, absX);
-        cv::convertScaleAbs(gradY, absY);
-
-        cv::addWeighted(absX, 0.5, absY, 0.5, 0, edgeImage);
-    } else if (method == EdgeMethod::Canny) {
-        cv::Canny(grayImage, edgeImage, cannyThreshold1, cannyThreshold2);
+    // Snapshot parameters; the UI may edit them while we compute
+    EdgeMethod edgeMethod;
+    int ksize, threshold1, threshold2;
+    bool overlay;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        edgeMethod = method;
+        ksize = sobelKernelSize;
+        threshold1 = cannyThreshold1;
+        threshold2 = cannyThreshold2;
+        overlay = overlayEdges;
     }
 
-    if (overlayEdges && inputImage.channels() == 3) {
-        cv::Mat colorEdges;
-        cv::cvtColor(edgeImage, colorEdges, cv::COLOR_GRAY2BGR);
-        outputImage = inputImage.clone();
-        cv::addWeighted(colorEdges, 1.0, outputImage, 1.0, 0.0, outputImage);
-    } else {
-        cv::cvtColor(edgeImage, outputImage, cv::COLOR_GRAY2BGR);
+    cv::Mat edges, result;
+    if (edgeMethod == EdgeMethod::Sobel) {
+        sobelEdges(grayImage, ksize, edges);
+    } else if (edgeMethod == EdgeMethod::Canny) {
+        cv::Canny(grayImage, edges, threshold1, threshold2);
     }
+    composeOutput(inputImage, edges, overlay, result);
 
-    dirty = false;
+    std::lock_guard<std::mutex> lock(stateMutex);
+    edgeImage = edges;
+    outputImage = result;
 }
 
-void EdgeDetectionNode::drawUI() {
-    ImGui::Text("Edge Detection Node");
-    bool changed = false;
-
-    const char* methods[] = { "Sobel", "Canny" };
-    int methodIdx = static_cast<int>(method);
-    if (ImGui::Combo("Method", &methodIdx, methods, IM_ARRAYSIZE(methods))) {
-        method = static_cast<EdgeMethod>(methodIdx);
-        changed = true;
-    }
+void EdgeDetectionNode::sobelEdges(const cv::Mat& gray, int ksize, cv::Mat& edges) {
+    cv::Mat gradX, gradY;
+    cv::Sobel(gray, gradX, CV_16S, 1, 0, ksize);
+    cv::Sobel(gray, gradY, CV_16S, 0, 1, ksize);
 
-    if (method == EdgeMethod::Sobel) {
-        changed |= ImGui::SliderInt("Sobel Kernel Size", &sobelKernelSize, 1, 7);
-        if (sobelKernelSize % 2 == 0) sobelKernelSize += 1; // Ensure it's odd
-    } else if (method == EdgeMethod::Canny) {
-        changed |= ImGui::SliderInt("Canny Threshold 1", &cannyThreshold1, 0, 255);
-        changed |= ImGui::SliderInt("Canny Threshold 2", &cannyThreshold2, 0, 255);
-    }
+    cv::Mat absX, absY;
+    cv::convertScaleAbs(gradX, absX);
+    cv::convertScaleAbs(gradY, absY);
 
-    changed |= ImGui::Checkbox("Overlay on Original", &overlayEdges);
+    cv::addWeighted(absX, 0.5, absY, 0.5, 0, edges);
+}
 
-    if (changed) {
-        dirty = true;
+void EdgeDetectionNode::composeOutput(const cv::Mat& input, const cv::Mat& edges, bool overlay, cv::Mat& result) {
+    if (overlay && input.channels() == 3) {
+        cv::Mat colorEdges;
+        cv::cvtColor(edges, colorEdges, cv::COLOR_GRAY2BGR);
+        cv::addWeighted(colorEdges, 1.0, input, 1.0, 0.0, result);
+    } else {
+        cv::cvtColor(edges, result, cv::COLOR_GRAY2BGR);
     }
+}
 
-    if (dirty) {
-        process();
-    }
-    if (ImGui::Button("Reset")) {
-        reset(); // Call the reset method
-    }
+bool EdgeDetectionNode::getTileKernel(TileKernel& kernel) const {
+    // Canny's hysteresis follows edges across the whole image
+    if (method != EdgeMethod::Sobel)
+        return false;
+
+    int ksize = sobelKernelSize;
+    bool overlay = overlayEdges;
+    kernel.halo = std::max(1, ksize / 2); // ksize 1 still reads one neighbour
+    kernel.outputChannels = 3;
+    kernel.apply = [ksize, overlay](const cv::Mat& src, const cv::Rect&, cv::Mat& dst) {
+        cv::Mat gray, edges;
+        if (src.channels() == 3)
+            cv::cvtColor(src, gray, cv::COLOR_BGR2GRAY);
+        else
+            gray = src;
+        sobelEdges(gray, ksize, edges);
+        composeOutput(src, edges, overlay, dst);
+    };
+    return true;
+}
+
+bool EdgeDetectionNode::getInputRegion(int, const cv::Rect& outputRegion, cv::Rect& inputRegion) const {
+    if (method != EdgeMethod::Sobel)
+        return false; // Canny, see getTileKernel()
+    int reach = std::max(1, sobelKernelSize / 2);
+    inputRegion = growRegion(outputRegion, reach, reach);
+    return true;
 }
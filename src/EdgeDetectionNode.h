@@ -12,7 +12,22 @@ public:
     void setInputImage(const cv::Mat& image) ;
     const cv::Mat& getOutputImage() const;
     void process() override;
-    void drawUI() override;
+    const char* getTypeName() const override { return "EdgeDetection"; }
+    void visitParams(ParamVisitor& v) override {
+        v.visit("method", method);
+        v.visit("sobelKernelSize", sobelKernelSize);
+        v.visit("cannyThreshold1", cannyThreshold1);
+        v.visit("cannyThreshold2", cannyThreshold2);
+        v.visit("overlay", overlayEdges);
+        clampParam(method, EdgeMethod::Sobel, EdgeMethod::Canny);
+        clampParam(sobelKernelSize, 1, 7);
+        sobelKernelSize |= 1; // cv::Sobel takes 1, 3, 5 or 7
+        clampParam(cannyThreshold1, 0, 255);
+        clampParam(cannyThreshold2, 0, 255);
+    }
+    friend class NodePanels; // Property panel, drawn by the GUI
+    bool getTileKernel(TileKernel& kernel) const override;
+    bool getInputRegion(int port, const cv::Rect& outputRegion, cv::Rect& inputRegion) const override;
     void reset() override {
         NodeBase::reset(); // Call base class reset
         overlayEdges = true;
@@ -23,7 +38,10 @@ public:
     }
 
 private:
-    cv::Mat inputImage;
+    static void sobelEdges(const cv::Mat& gray, int ksize, cv::Mat& edges);
+    // Edges over the input (overlay) or on their own, as BGR
+    static void composeOutput(const cv::Mat& input, const cv::Mat& edges, bool overlay, cv::Mat& result);
+
     cv::Mat grayImage;
     cv::Mat edgeImage;
     bool overlayEdges;
@@ -33,7 +51,4 @@ private:
     int sobelKernelSize;
     int cannyThreshold1;
     int cannyThreshold2;
-
-    // Output
-    cv::Mat outputImage;
 };
@@ -0,0 +1,277 @@
+#include "GraphFile.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+const char kMagic[4] = { 'N', 'G', 'R', 'B' };
+
+// --- Binary encoding ---
+
+void putU32(std::string& out, uint32_t v) {
+    char bytes[4] = { char(v & 0xff), char((v >> 8) & 0xff), char((v >> 16) & 0xff), char(v >> 24) };
+    out.append(bytes, 4);
+}
+
+void putFloat(std::string& out, float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    putU32(out, bits);
+}
+
+void putString(std::string& out, const std::string& s) {
+    putU32(out, static_cast<uint32_t>(s.size()));
+    out += s;
+}
+
+// Bounds-checked cursor over the input; any overrun sets 'ok' to false
+struct Reader {
+    const unsigned char* p;
+    const unsigned char* end;
+    bool ok = true;
+
+    bool has(size_t n) {
+        if (static_cast<size_t>(end - p) < n)
+            ok = false;
+        return ok;
+    }
+    uint32_t u32() {
+        if (!has(4))
+            return 0;
+        uint32_t v = uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+        p += 4;
+        return v;
+    }
+    float f32() {
+        uint32_t bits = u32();
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    std::string str() {
+        uint32_t n = u32();
+        if (!has(n))
+            return std::string();
+        std::string s(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return s;
+    }
+    // Element count, rejected if it can't possibly fit in the rest of the data
+    uint32_t count(size_t minBytesEach) {
+        uint32_t n = u32();
+        if (ok && n > static_cast<size_t>(end - p) / minBytesEach)
+            ok = false;
+        return ok ? n : 0;
+    }
+};
+
+// --- Text encoding ---
+
+std::string formatFloat(float v) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", v); // Round-trips exactly
+    return buffer;
+}
+
+bool validLinks(const GraphDesc& desc) {
+    int n = static_cast<int>(desc.nodes.size());
+    for (const GraphDesc::Link& link : desc.links) {
+        if (link.source < 0 || link.source >= n || link.target < 0 || link.target >= n ||
+            link.sourcePort < 0 || link.targetPort < 0)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+namespace GraphFile {
+
+std::string toText(const GraphDesc& desc) {
+    std::string out = "nodegraph " + std::to_string(kVersion) + "\n";
+    for (const GraphDesc::Node& node : desc.nodes) {
+        out += "node " + node.type + "\n";
+        for (const GraphDesc::Param& param : node.params) {
+            out += "  " + param.name;
+            for (float v : param.values)
+                out += " " + formatFloat(v);
+            out += "\n";
+        }
+    }
+    for (const GraphDesc::Link& link : desc.links) {
+        out += "link " + std::to_string(link.source) + " " + std::to_string(link.sourcePort) + " " +
+               std::to_string(link.target) + " " + std::to_string(link.targetPort) + "\n";
+    }
+    return out;
+}
+
+bool parseText(const std::string& text, GraphDesc& desc) {
+    desc = GraphDesc();
+    std::istringstream in(text);
+    std::string line;
+    int lineNumber = 0;
+    bool headerSeen = false;
+
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        std::istringstream fields(line);
+        std::string keyword;
+        if (!(fields >> keyword))
+            continue; // Blank line
+
+        bool ok = true;
+        if (!headerSeen) {
+            int version = 0;
+            ok = keyword == "nodegraph" && (fields >> version) && version >= 1;
+            if (ok && version > kVersion) {
+                std::cerr << "GraphFile: format version " << version << " is newer than supported ("
+                          << kVersion << ")" << std::endl;
+                return false;
+            }
+            headerSeen = true;
+        } else if (keyword == "node") {
+            GraphDesc::Node node;
+            ok = static_cast<bool>(fields >> node.type);
+            desc.nodes.push_back(node);
+        } else if (keyword == "link") {
+            GraphDesc::Link link;
+            ok = static_cast<bool>(fields >> link.source >> link.sourcePort >> link.target >> link.targetPort);
+            desc.links.push_back(link);
+        } else if (!desc.nodes.empty()) {
+            // Anything else is a parameter of the last node
+            GraphDesc::Param param;
+            param.name = keyword;
+            std::string value;
+            while (ok && fields >> value) {
+                char* end = nullptr;
+                param.values.push_back(std::strtof(value.c_str(), &end));
+                ok = end && *end == '\0';
+            }
+            desc.nodes.back().params.push_back(param);
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "GraphFile: syntax error on line " << lineNumber << ": " << line << std::endl;
+            return false;
+        }
+    }
+
+    if (!headerSeen) {
+        std::cerr << "GraphFile: missing 'nodegraph' header" << std::endl;
+        return false;
+    }
+    if (!validLinks(desc)) {
+        std::cerr << "GraphFile: link refers to a missing node" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string toBinary(const GraphDesc& desc) {
+    std::string out(kMagic, sizeof(kMagic));
+    putU32(out, kVersion);
+    putU32(out, static_cast<uint32_t>(desc.nodes.size()));
+    for (const GraphDesc::Node& node : desc.nodes) {
+        putString(out, node.type);
+        putU32(out, static_cast<uint32_t>(node.params.size()));
+        for (const GraphDesc::Param& param : node.params) {
+            putString(out, param.name);
+            putU32(out, static_cast<uint32_t>(param.values.size()));
+            for (float v : param.values)
+                putFloat(out, v);
+        }
+    }
+    putU32(out, static_cast<uint32_t>(desc.links.size()));
+    for (const GraphDesc::Link& link : desc.links) {
+        putU32(out, static_cast<uint32_t>(link.source));
+        putU32(out, static_cast<uint32_t>(link.sourcePort));
+        putU32(out, static_cast<uint32_t>(link.target));
+        putU32(out, static_cast<uint32_t>(link.targetPort));
+    }
+    return out;
+}
+
+bool parseBinary(const std::string& data, GraphDesc& desc) {
+    desc = GraphDesc();
+    if (data.size() < sizeof(kMagic) || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        std::cerr << "GraphFile: not a binary graph file" << std::endl;
+        return false;
+    }
+    Reader r{ reinterpret_cast<const unsigned char*>(data.data()) + sizeof(kMagic),
+              reinterpret_cast<const unsigned char*>(data.data()) + data.size() };
+
+    uint32_t version = r.u32();
+    if (r.ok && version > static_cast<uint32_t>(kVersion)) {
+        std::cerr << "GraphFile: format version " << version << " is newer than supported ("
+                  << kVersion << ")" << std::endl;
+        return false;
+    }
+
+    desc.nodes.resize(r.count(8));
+    for (GraphDesc::Node& node : desc.nodes) {
+        node.type = r.str();
+        node.params.resize(r.count(8));
+        for (GraphDesc::Param& param : node.params) {
+            param.name = r.str();
+            param.values.resize(r.count(4));
+            for (float& v : param.values)
+                v = r.f32();
+        }
+    }
+    desc.links.resize(r.count(16));
+    for (GraphDesc::Link& link : desc.links) {
+        link.source = static_cast<int>(r.u32());
+        link.sourcePort = static_cast<int>(r.u32());
+        link.target = static_cast<int>(r.u32());
+        link.targetPort = static_cast<int>(r.u32());
+    }
+
+    if (!r.ok || version == 0) {
+        std::cerr << "GraphFile: truncated or corrupt binary graph" << std::endl;
+        return false;
+    }
+    if (!validLinks(desc)) {
+        std::cerr << "GraphFile: link refers to a missing node" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool load(const std::string& path, GraphDesc& desc) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "GraphFile: cannot open " << path << std::endl;
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (data.size() >= sizeof(kMagic) && std::memcmp(data.data(), kMagic, sizeof(kMagic)) == 0)
+        return parseBinary(data, desc);
+    return parseText(data, desc);
+}
+
+bool save(const std::string& path, const GraphDesc& desc) {
+    bool binary = path.size() >= 4 && path.compare(path.size() - 4, 4, ".ngb") == 0;
+    std::string data = binary ? toBinary(desc) : toText(desc);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(data.data(), data.size())) {
+        std::cerr << "GraphFile: cannot write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace GraphFile
@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Saved form of a pipeline: node types, their parameters and the connections
+// between them, independent of any live node objects (see Pipeline::create
+// and Pipeline::describe). Nodes are referenced by their index in 'nodes'.
+struct GraphDesc {
+    struct Param {
+        std::string name;
+        std::vector<float> values; // Ints, bools and enums are stored as floats
+    };
+    struct Node {
+        std::string type; // NodeBase::getTypeName()
+        std::vector<Param> params;
+    };
+    struct Link {
+        int source = 0;
+        int sourcePort = 0;
+        int target = 0;
+        int targetPort = 0;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Link> links;
+};
+
+// Reading and writing GraphDesc in two encodings of the same content:
+//
+// Text, for editing and diffs:
+//     nodegraph 1
+//     node Blur
+//       radius 5
+//     link 0 0 1 0
+//
+// Binary, for fast loading: the "NGRB" magic, then the same records as
+// length-prefixed little-endian fields. Parsing is a single pass over the
+// buffer with no tokenizing or number formatting.
+//
+// Both carry a format version; files newer than kVersion are rejected.
+// load() detects the encoding from the content, save() picks binary for the
+// ".ngb" extension and text otherwise.
+namespace GraphFile {
+
+const int kVersion = 1;
+
+std::string toText(const GraphDesc& desc);
+bool parseText(const std::string& text, GraphDesc& desc);
+
+std::string toBinary(const GraphDesc& desc);
+bool parseBinary(const std::string& data, GraphDesc& desc);
+
+bool load(const std::string& path, GraphDesc& desc);
+bool save(const std::string& path, const GraphDesc& desc);
+
+} // namespace GraphFile
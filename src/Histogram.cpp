@@ -0,0 +1,115 @@
+#include "Histogram.h"
+#include <algorithm>
+#include <cfloat>
+#include <mutex>
+
+namespace {
+
+// Tables per channel, used in turn by consecutive pixels
+constexpr int kLanes = 4;
+
+// Rows between cancellation checks
+constexpr int kBandRows = 64;
+
+// Adds 'rows' of an 8-bit image to counts[lane * cn + c]. CN is the channel
+// count when known at compile time, so the inner loops unroll; 0 otherwise.
+template <int CN>
+void countRows(const cv::Mat& image, const cv::Range& rows, std::vector<Histogram::Bins>& counts) {
+    const int cn = CN ? CN : image.channels();
+    const int width = image.cols;
+    for (int y = rows.start; y < rows.end; ++y) {
+        const uchar* p = image.ptr<uchar>(y);
+        int x = 0;
+        for (; x + kLanes <= width; x += kLanes, p += kLanes * cn)
+            for (int lane = 0; lane < kLanes; ++lane)
+                for (int c = 0; c < cn; ++c)
+                    ++counts[lane * cn + c][p[lane * cn + c]];
+        for (; x < width; ++x, p += cn)
+            for (int c = 0; c < cn; ++c)
+                ++counts[c][p[c]];
+    }
+}
+
+// Per-channel bins of an 8-bit image; false if cancelled
+bool count(const cv::Mat& image, std::vector<Histogram::Bins>& bins, const CancelToken* cancel) {
+    int cn = image.channels();
+    auto countBand = cn == 1 ? countRows<1> : cn == 3 ? countRows<3> : cn == 4 ? countRows<4> : countRows<0>;
+    bins.assign(cn, Histogram::Bins{});
+    std::mutex mutex;
+
+    // One stripe per thread keeps the merges down to a handful
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& rows) {
+        std::vector<Histogram::Bins> counts(kLanes * cn, Histogram::Bins{});
+        for (int y = rows.start; y < rows.end; y += kBandRows) {
+            if (cancel && cancel->isCancelled())
+                return;
+            countBand(image, cv::Range(y, std::min(y + kBandRows, rows.end)), counts);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int lane = 0; lane < kLanes; ++lane)
+            for (int c = 0; c < cn; ++c)
+                for (int v = 0; v < 256; ++v)
+                    bins[c][v] += counts[lane * cn + c][v];
+    }, cv::getNumThreads());
+    return !(cancel && cancel->isCancelled());
+}
+
+cv::Mat to8Bit(const cv::Mat& image) {
+    if (image.depth() == CV_8U)
+        return image;
+    cv::Mat converted;
+    image.convertTo(converted, CV_8U);
+    return converted;
+}
+
+} // namespace
+
+std::shared_ptr<const Histogram> Histogram::compute(const cv::Mat& image, const cv::Mat& luminance,
+                                                    const CancelToken* cancel) {
+    std::shared_ptr<Histogram> histogram = std::make_shared<Histogram>();
+    if (image.empty())
+        return histogram;
+    if (!count(to8Bit(image), histogram->channels, cancel))
+        return nullptr;
+
+    if (image.channels() == 1) {
+        histogram->luminance = histogram->channels[0];
+    } else if (!luminance.empty()) {
+        std::vector<Bins> gray;
+        if (!count(to8Bit(luminance), gray, cancel))
+            return nullptr;
+        histogram->luminance = gray[0];
+    }
+    histogram->total = image.total();
+    return histogram;
+}
+
+// Same search as OpenCV's Otsu implementation, so both give the same value:
+// the level that maximizes the between-class variance
+int Histogram::otsuThreshold() const {
+    if (total == 0)
+        return 0;
+    double scale = 1.0 / total, mu = 0.0;
+    for (int i = 0; i < 256; ++i)
+        mu += i * static_cast<double>(luminance[i]);
+    mu *= scale;
+
+    double mu1 = 0.0, q1 = 0.0, maxSigma = 0.0;
+    int best = 0;
+    for (int i = 0; i < 256; ++i) {
+        double p = luminance[i] * scale;
+        mu1 *= q1;
+        q1 += p;
+        double q2 = 1.0 - q1;
+        if (std::min(q1, q2) < FLT_EPSILON || std::max(q1, q2) > 1.0 - FLT_EPSILON)
+            continue;
+        mu1 = (mu1 + i * p) / q1;
+        double mu2 = (mu - q1 * mu1) / q2;
+        double sigma = q1 * q2 * (mu1 - mu2) * (mu1 - mu2);
+        if (sigma > maxSigma) {
+            maxSigma = sigma;
+            best = i;
+        }
+    }
+    return best;
+}
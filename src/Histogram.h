@@ -0,0 +1,41 @@
+#pragma once
+#include "CancelToken.h"
+#include <opencv2/core.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 256-bin histograms of an image, every channel counted in one pass.
+//
+// The rows are split across threads. Each thread counts its rows into private
+// tables, four per channel taken in turn by consecutive pixels, so runs of
+// equal values (flat areas) don't serialize on one counter; the tables are
+// summed once at the end. Images other than 8-bit are converted first,
+// saturating, as the 8-bit paths elsewhere do.
+//
+// A computed Histogram never changes and is shared through shared_ptr, so
+// readers (the UI, downstream nodes) can keep one while a newer one replaces it.
+class Histogram {
+public:
+    typedef std::array<uint32_t, 256> Bins;
+
+    // Counts every channel of 'image'. 'luminance' is the gray version of a
+    // colour image and gets bins of its own; a single-channel image is its
+    // own luminance. Returns null if 'cancel' was raised midway.
+    static std::shared_ptr<const Histogram> compute(const cv::Mat& image, const cv::Mat& luminance = cv::Mat(),
+                                                    const CancelToken* cancel = nullptr);
+
+    int getChannels() const { return static_cast<int>(channels.size()); }
+    const Bins& getChannel(int c) const { return channels[c]; } // In the image's order (B, G, R)
+    const Bins& getLuminance() const { return luminance; }
+    uint64_t getTotal() const { return total; }                  // Pixels counted
+
+    // Threshold cv::threshold picks with THRESH_OTSU for the luminance
+    int otsuThreshold() const;
+
+private:
+    std::vector<Bins> channels;
+    Bins luminance{};
+    uint64_t total = 0;
+};
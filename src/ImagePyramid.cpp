@@ -0,0 +1,70 @@
+#include "ImagePyramid.h"
+#include "Profiler.h"
+#include <opencv2/imgproc.hpp>
+
+ImagePyramid::ImagePyramid(const cv::Mat& image) : size(image.size()) {
+    levels.push_back(image);
+}
+
+cv::Mat ImagePyramid::forWidth(int width, bool build) {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // Levels shrink, so the last one wide enough is the smallest
+            size_t best = 0;
+            for (size_t i = 1; i < levels.size() && levels[i].cols >= width; ++i)
+                best = i;
+            bool finer = best + 1 == levels.size() && levels.back().cols / 2 >= width;
+            if (!build || !finer)
+                return levels[best];
+        }
+        if (!buildNext()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return levels.back();
+        }
+    }
+}
+
+cv::Mat ImagePyramid::level(int index) {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (index >= 0 && index < static_cast<int>(levels.size()))
+                return levels[index];
+        }
+        if (!buildNext()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return levels.back();
+        }
+    }
+}
+
+int ImagePyramid::getBuiltLevels() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(levels.size());
+}
+
+bool ImagePyramid::buildNext() {
+    cv::Mat source;
+    size_t index;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        source = levels.back();
+        index = levels.size();
+    }
+    if (source.empty() || (source.cols < 2 && source.rows < 2))
+        return false;
+
+    cv::Mat next;
+    {
+        ProfileScope scope("Pyramid level", "pyramid");
+        cv::Size half((source.cols + 1) / 2, (source.rows + 1) / 2);
+        cv::resize(source, next, half, 0, 0, cv::INTER_AREA);
+    }
+
+    // Another thread may have built the same level meanwhile; keep the first
+    std::lock_guard<std::mutex> lock(mutex);
+    if (levels.size() == index)
+        levels.push_back(next);
+    return true;
+}
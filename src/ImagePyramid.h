@@ -0,0 +1,40 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <mutex>
+#include <vector>
+
+// Mip pyramid of an image, for drawing it at reduced size without going back
+// to full resolution every time (previews, thumbnails, proxy inputs).
+//
+// Level 0 is the image itself (shared, not copied); each further level is the
+// previous one halved by area averaging. Levels are built on first request
+// and kept, so each costs one pass over the level above it, once. A pyramid
+// belongs to one image generation: a changed image gets a new pyramid, and
+// only the levels someone asks for are rebuilt.
+//
+// Thread safe. Levels are computed outside the lock, so a reader that only
+// wants what is already built (build = false, e.g. the UI thread) never waits
+// for a level being built on another thread.
+class ImagePyramid {
+public:
+    explicit ImagePyramid(const cv::Mat& image);
+
+    // Smallest level at least 'width' pixels wide, or level 0 if the image
+    // is no wider than that. With build = false, the best level built so far.
+    cv::Mat forWidth(int width, bool build = true);
+
+    // Level 'index' (0 = full size), building it first if needed; clamped to
+    // the smallest level
+    cv::Mat level(int index);
+
+    int getBuiltLevels() const;
+    cv::Size getSize() const { return size; }
+
+private:
+    // Builds the level below the last one; false once levels reach one pixel
+    bool buildNext();
+
+    cv::Size size;
+    mutable std::mutex mutex;
+    std::vector<cv::Mat> levels; // Guarded by mutex; only ever appended
+};
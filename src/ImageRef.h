@@ -0,0 +1,27 @@
+#pragma once
+#include <opencv2/core.hpp>
+
+// Read-only, reference-counted image handle used at node boundaries.
+//
+// Copying an ImageRef shares the pixel buffer (cv::Mat reference counting);
+// nothing is deep-copied when an image is handed from node to node or
+// forwarded by a pass-through node. Holders only get a const view: shared
+// buffers are never modified. Instead every node renders into a fresh
+// buffer and publishes that as its output.
+//
+// The same rule applies to the cv::Mat members of the nodes: inputImage and
+// published outputImage buffers are shared and must never be written in
+// place.
+class ImageRef {
+public:
+    ImageRef() = default;
+    ImageRef(const cv::Mat& image) : mat(image) {}
+
+    const cv::Mat& read() const { return mat; }
+
+    bool empty() const { return mat.empty(); }
+    void release() { mat.release(); }
+
+private:
+    cv::Mat mat;
+};
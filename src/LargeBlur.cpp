@@ -0,0 +1,167 @@
+#include "LargeBlur.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace LargeBlur {
+
+namespace {
+
+constexpr int kBoxPasses = 3;
+
+// Third-order recursion w[n] = B x[n] + b1 w[n-1] + b2 w[n-2] + b3 w[n-3]
+struct Recursion {
+    double B, b1, b2, b3;
+};
+
+// Young-van Vliet filter with the poles of van Vliet, Young and Verbeek
+// (1998), scaled so the forward-backward pair has exactly the variance
+// sigma^2; the original fit for the coefficients drifts by up to 10%.
+Recursion recursion(double sigma) {
+    const std::complex<double> d1(1.41650, 1.00829); // And its conjugate
+    const double d3 = 1.86543;
+    auto variance = [&](double q) {
+        std::complex<double> p = std::pow(d1, 1.0 / q);
+        double r = std::pow(d3, 1.0 / q);
+        return 2.0 * (2.0 * p / ((p - 1.0) * (p - 1.0))).real() + 2.0 * r / ((r - 1.0) * (r - 1.0));
+    };
+    // The spread grows about linearly with q; converges in a few steps
+    double q = sigma / 2.0;
+    for (int i = 0; i < 20; ++i)
+        q *= sigma / std::sqrt(variance(q));
+
+    std::complex<double> p = std::pow(d1, 1.0 / q), pc = std::conj(p);
+    double r = std::pow(d3, 1.0 / q);
+    // Coefficients of (1 - z^-1 / p)(1 - z^-1 / conj(p))(1 - z^-1 / r)
+    Recursion c;
+    c.b1 = (1.0 / p + 1.0 / pc).real() + 1.0 / r;
+    c.b2 = -(1.0 / (p * pc) + 1.0 / (p * r) + 1.0 / (pc * r)).real();
+    c.b3 = (1.0 / (p * pc * r)).real();
+    c.B = 1.0 - (c.b1 + c.b2 + c.b3);
+    return c;
+}
+
+// Box of 2 * radius + 1 taps plus 'alpha' on the next tap at each end, so
+// kBoxPasses of them have exactly the variance sigma^2
+struct ExtendedBox {
+    int radius;
+    double alpha;
+    double scale; // 1 / total weight
+};
+
+ExtendedBox extendedBox(double sigma) {
+    double s = sigma * sigma / kBoxPasses;
+    int r = std::max(0, static_cast<int>(std::floor(0.5 * std::sqrt(12.0 * s + 1.0) - 0.5)));
+    double alpha = (2 * r + 1) * (r * (r + 1) - 3.0 * s) / (6.0 * (s - (r + 1.0) * (r + 1.0)));
+    return { r, alpha, 1.0 / (2.0 * alpha + 2 * r + 1) };
+}
+
+// Forward then backward pass, each starting from the steady state of a
+// constant signal; the padding around the row absorbs the start-up error
+void recursiveLine(double* x, int length, const Recursion& c) {
+    double w1 = x[0], w2 = x[0], w3 = x[0];
+    for (int i = 0; i < length; ++i) {
+        double w = c.B * x[i] + c.b1 * w1 + c.b2 * w2 + c.b3 * w3;
+        w3 = w2;
+        w2 = w1;
+        w1 = x[i] = w;
+    }
+    double y1 = x[length - 1], y2 = y1, y3 = y1;
+    for (int i = length - 1; i >= 0; --i) {
+        double y = c.B * x[i] + c.b1 * y1 + c.b2 * y2 + c.b3 * y3;
+        y3 = y2;
+        y2 = y1;
+        y1 = x[i] = y;
+    }
+}
+
+// One pass over in[lo, hi) into out, reading radius + 1 samples beyond each end
+void boxPass(const double* in, double* out, int lo, int hi, const ExtendedBox& b) {
+    int r = b.radius;
+    double sum = 0.0;
+    for (int k = -r; k <= r; ++k)
+        sum += in[lo + k];
+    for (int i = lo; i < hi; ++i) {
+        out[i] = b.scale * (sum + b.alpha * (in[i - r - 1] + in[i + r + 1]));
+        sum += in[i + r + 1] - in[i - r];
+    }
+}
+
+// Filters every row of a float image along x, in place
+void filterRows(cv::Mat& image, double sigma, Method method, const CancelToken* cancel) {
+    int n = image.cols, cn = image.channels();
+    int pad = reach(sigma, method);
+    int length = n + 2 * pad;
+    Recursion coefficients = recursion(sigma);
+    ExtendedBox box = extendedBox(sigma);
+
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& rows) {
+        std::vector<double> line(length), other(method == Method::Box ? length : 0);
+        for (int y = rows.start; y < rows.end; ++y) {
+            if (cancel && cancel->isCancelled())
+                return;
+            float* row = image.ptr<float>(y);
+            for (int c = 0; c < cn; ++c) {
+                // Channel c of the row, reflected into the padding
+                for (int i = 0; i < pad; ++i) {
+                    line[i] = row[cv::borderInterpolate(i - pad, n, cv::BORDER_REFLECT_101) * cn + c];
+                    line[pad + n + i] = row[cv::borderInterpolate(n + i, n, cv::BORDER_REFLECT_101) * cn + c];
+                }
+                for (int i = 0; i < n; ++i)
+                    line[pad + i] = row[i * cn + c];
+
+                const double* result = line.data();
+                if (method == Method::Recursive) {
+                    recursiveLine(line.data(), length, coefficients);
+                } else {
+                    // Each pass leaves radius + 1 fewer valid samples at both ends
+                    double* in = line.data();
+                    double* out = other.data();
+                    for (int pass = 1; pass <= kBoxPasses; ++pass) {
+                        int margin = pass * (box.radius + 1);
+                        boxPass(in, out, margin, length - margin, box);
+                        std::swap(in, out);
+                    }
+                    result = in;
+                }
+
+                for (int i = 0; i < n; ++i)
+                    row[i * cn + c] = static_cast<float>(result[pad + i]);
+            }
+        }
+    });
+}
+
+} // namespace
+
+double sigmaForRadius(int radius) {
+    return 0.3 * (radius - 1) + 0.8;
+}
+
+int reach(double sigma, Method method) {
+    if (method == Method::Box)
+        return kBoxPasses * (extendedBox(sigma).radius + 1);
+    return static_cast<int>(std::ceil(4.0 * sigma));
+}
+
+void blur(const cv::Mat& src, cv::Mat& dst, double sigma, bool horizontal, bool vertical,
+          Method method, const CancelToken* cancel) {
+    CV_Assert(sigma >= kMinSigma);
+    cv::Mat work;
+    src.convertTo(work, CV_32F);
+    if (horizontal)
+        filterRows(work, sigma, method, cancel);
+    if (vertical) {
+        cv::Mat transposed;
+        cv::transpose(work, transposed);
+        filterRows(transposed, sigma, method, cancel);
+        cv::transpose(transposed, work);
+    }
+    if (cancel && cancel->isCancelled())
+        return;
+    work.convertTo(dst, src.type());
+}
+
+} // namespace LargeBlur
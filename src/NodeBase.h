@@ -1,18 +1,259 @@
 #pragma once
 
+#include "CancelToken.h"
+#include "ImagePyramid.h"
+#include "ImageRef.h"
+#include "Profiler.h"
 #include <opencv2/core.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <type_traits>
+#include <vector>
+
+// Kind of image a port carries. Gray ports only accept single-channel images.
+enum class PortType {
+    Image,
+    Gray
+};
+
+// Named, typed connection point of a node (see NodeGraph)
+struct Port {
+    std::string name;
+    PortType type = PortType::Image;
+    bool optional = false; // Node can run without this input connected
+};
+
+// Walks a node's parameters by name, for saving and loading graphs (see
+// GraphFile). The same visitParams() code serves both directions: a writer
+// reads the references it is handed, a reader assigns to them.
+class ParamVisitor {
+public:
+    virtual ~ParamVisitor() = default;
+
+    virtual void visit(const char* name, int& value) = 0;
+    virtual void visit(const char* name, float& value) = 0;
+    virtual void visit(const char* name, bool& value) = 0;
+    virtual void visit(const char* name, std::vector<float>& values) = 0;
+
+    // Enums are stored as their integer value
+    template <typename E, typename = typename std::enable_if<std::is_enum<E>::value>::type>
+    void visit(const char* name, E& value) {
+        int v = static_cast<int>(value);
+        visit(name, v);
+        value = static_cast<E>(v);
+    }
+};
 
 // Base class for all image processing nodes
+//
+// Change tracking is generation based: every image buffer a node produces is
+// stamped with a monotonically increasing generation id, and every parameter
+// edit bumps the node's parameter generation. A node only reprocesses when the
+// input or parameter generation differs from the one it last computed from, so
+// an idle graph does no pixel work at all.
+//
+// Threading: process() runs on the evaluation thread while the GUI edits
+// parameters from its own thread. stateMutex guards everything both sides
+// touch, i.e. the parameters and the published outputs. process() copies its
+// parameters under the lock, computes into local buffers without it, and
+// publishes the results under the lock again; the GUI draws a node's property
+// panel (gui/NodePanels) with the lock held. Input images are only touched by
+// the evaluation thread.
+//
+// Cancellation: a pass can be abandoned midway when newer changes make it
+// stale (see CancelToken). Nodes with long loops poll isCancelled() between
+// rows or bands and return without publishing; evaluate() then leaves them
+// dirty.
+//
+// Nodes have no UI or OpenGL dependency, so they build into the headless core
+// library shared by the GUI, the batch tool and benchmarks.
+//
+// Buffers: images are shared between nodes rather than copied, so inputImage
+// and any published outputImage must be treated as read-only (see ImageRef).
 class NodeBase {
 public:
-    NodeBase(const std::string& name = "UnnamedNode") : nodeName(name) {}
+    NodeBase(const std::string& name = "UnnamedNode") : nodeName(name) {
+        // Default: one image in, one image out. Nodes adjust in their constructor.
+        inputPorts = { { "Image" } };
+        outputPorts = { { "Image" } };
+    }
     virtual ~NodeBase() = default;
 
-    // Sets the input image and marks the node as needing reprocessing
+    // Returns a new, globally unique generation id (never 0)
+    static uint64_t nextGeneration() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    // Sets the input image. The buffer is shared, not copied (see ImageRef).
     virtual void setInputImage(const cv::Mat& image) {
-        inputImage = image.clone();
-        dirty = true;
+        inputImage = image;
+    }
+
+    // Sets the image on the given input port. Port 0 maps to setInputImage().
+    virtual void setInput(int port, const cv::Mat& image) {
+        if (port == 0)
+            setInputImage(image);
+    }
+
+    // Returns the image on the given output port. Port 0 maps to getOutputImage().
+    virtual const cv::Mat& getOutput(int port) const {
+        (void)port;
+        return getOutputImage();
+    }
+
+    // True if the node currently leaves input 0 untouched (e.g. disabled).
+    // The graph then forwards the input buffer without calling process().
+    virtual bool isPassThrough() const {
+        return false;
+    }
+
+    // Per-pixel operation for tiled execution (see NodeGraph). apply() turns
+    // a region of input 0 (placed at 'region' in the full image) into the
+    // same region of the output; only output pixels at least 'halo' pixels
+    // away from the region's inner edges need to be correct. It must not
+    // touch the node, as it runs concurrently on many tiles while the UI
+    // edits parameters. 8-bit input must give 8-bit output.
+    struct TileKernel {
+        int halo = 0;           // Spatial footprint in pixels, 0 for point-wise nodes
+        int outputChannels = 0; // 0 if the output has the input's channel count
+        std::function<void(const cv::Mat& src, const cv::Rect& region, cv::Mat& dst)> apply;
+    };
+
+    // Fills 'kernel' for the current parameters, or returns false if the node
+    // can't run tile by tile (global statistics, several inputs or outputs,
+    // output size unrelated to the input). Called with stateMutex held.
+    virtual bool getTileKernel(TileKernel& kernel) const {
+        (void)kernel;
+        return false;
+    }
+
+    // Point-wise step for fusion: consecutive point-wise nodes are compiled
+    // into one pass over the image (see PointProgram). 8-bit images only.
+    struct PointOp {
+        enum Kind {
+            Lut,   // Table lookup per channel
+            Gray,  // BGR to gray, same weights as cv::cvtColor
+            Blend  // Combines with 'operand' through blendRow
+        } kind = Lut;
+        std::vector<std::array<uchar, 256>> tables; // Lut: one per channel, or one for all
+        int channels = 0;                           // Lut: required channel count, 0 = any
+        void (*blendRow)(const uchar* a, const uchar* b, uchar* dst, int n, int weight) = nullptr;
+        int weight = 256;                           // Blend: opacity in 1/256 steps
+        cv::Mat operand;                            // Blend: image of the same size
+    };
+
+    // Appends the node's point-wise steps for the current parameters, or
+    // returns false if it isn't point-wise right now. Called with stateMutex
+    // held; inputs on ports other than 0 have already been fed.
+    virtual bool getPointOps(std::vector<PointOp>& ops) const {
+        (void)ops;
+        return false;
+    }
+
+    // Part of input 'port' needed to compute 'outputRegion' of the outputs
+    // (see NodeGraph::propagateRegion), in that input's pixels and not
+    // clipped to its bounds. Returns false if no part short of the whole
+    // input will do (global statistics, generated content). Called with
+    // stateMutex held, from the evaluation thread.
+    virtual bool getInputRegion(int port, const cv::Rect& outputRegion, cv::Rect& inputRegion) const {
+        (void)port;
+        (void)outputRegion;
+        (void)inputRegion;
+        return false;
+    }
+
+    // Publishes an output assembled from tiles in place of process().
+    // 'inputHeld' is false if the node wasn't first in its chain, so its
+    // inputs don't hold the image the tiles were computed from.
+    virtual void setTiledOutput(const cv::Mat& image, bool inputHeld) {
+        (void)inputHeld;
+        std::lock_guard<std::mutex> lock(stateMutex);
+        outputImage = image;
+        outputGeneration = nextGeneration();
+    }
+
+    // Drops the output of a node whose pixels only existed inside tiles, so
+    // it is reprocessed if it is ever evaluated on its own again
+    void invalidateOutput() {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        outputImage.release();
+        computedParamGeneration = 0;
+    }
+
+    const std::vector<Port>& getInputPorts() const {
+        return inputPorts;
+    }
+
+    const std::vector<Port>& getOutputPorts() const {
+        return outputPorts;
+    }
+
+    // Hands an upstream buffer to an input port. The image is only forwarded to
+    // setInput() when its generation differs from the one already held on that
+    // port. Returns true if the input actually changed.
+    bool feedInput(int port, const cv::Mat& image, uint64_t generation) {
+        if (port >= static_cast<int>(portGenerations.size()))
+            portGenerations.resize(port + 1, 0);
+        if (generation == portGenerations[port])
+            return false;
+        {
+            ProfileScope scope(nodeName.c_str(), "input"); // Includes any conversion
+            setInput(port, image);
+        }
+        portGenerations[port] = generation;
+        inputGeneration = nextGeneration(); // Combined stamp over all ports
+        return true;
+    }
+
+    bool feedInput(const cv::Mat& image, uint64_t generation) {
+        return feedInput(0, image, generation);
+    }
+
+    // Runs process() if the input or parameters changed since the last run and
+    // stamps the result with a fresh output generation.
+    // Returns true if the node was reprocessed.
+    bool evaluate() {
+        uint64_t params, input;
+        std::vector<cv::Mat> previous; // Published outputs, held so their buffers stay distinct
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (!isDirty())
+                return false;
+            params = paramGeneration;
+            input = inputGeneration;
+            for (size_t p = 0; p < outputPorts.size(); ++p)
+                previous.push_back(getOutput(static_cast<int>(p)));
+        }
+        {
+            ProfileScope scope(nodeName.c_str(), "process");
+            process();
+        }
+        // Abandoned midway: stay dirty so the next pass redoes the work. A
+        // node whose work couldn't be interrupted may have published anyway;
+        // its new buffers still get a generation of their own.
+        if (isCancelled()) {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            for (size_t p = 0; p < previous.size(); ++p) {
+                const cv::Mat& current = getOutput(static_cast<int>(p));
+                if (current.data != previous[p].data || current.size() != previous[p].size()) {
+                    outputGeneration = nextGeneration();
+                    break;
+                }
+            }
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(stateMutex);
+        computedParamGeneration = params;
+        computedInputGeneration = input;
+        outputGeneration = nextGeneration();
+        return true;
     }
 
     // Returns the processed output image
@@ -20,25 +261,106 @@ public:
         return outputImage;
     }
 
+    // Generation of the image returned by getOutputImage()
+    uint64_t getOutputGeneration() const {
+        return outputGeneration;
+    }
+
+    // Mip pyramid of the current output (see ImagePyramid), made on first
+    // request after each change of the output generation. Levels are built by
+    // whoever asks for them, so hand it to the evaluation thread rather than
+    // building on the UI thread. Call with stateMutex held.
+    std::shared_ptr<ImagePyramid> getOutputPyramid() {
+        if (!outputPyramid || outputPyramidGeneration != outputGeneration) {
+            outputPyramid = std::make_shared<ImagePyramid>(getOutputImage());
+            outputPyramidGeneration = outputGeneration;
+        }
+        return outputPyramid;
+    }
+
+    // Must be called whenever a parameter affecting the output changes
+    void markParametersChanged() {
+        paramGeneration = nextGeneration();
+    }
+
     // Clears the output and marks the node as dirty
     virtual void clearOutput() {
         outputImage.release();
-        dirty = true;
+        outputPyramid.reset();
+        markParametersChanged();
     }
 
-    // Getter for the dirty flag
+    // True if the input or parameters changed since the last process()
     bool isDirty() const {
-        return dirty;
+        return paramGeneration != computedParamGeneration ||
+               inputGeneration != computedInputGeneration;
     }
 
-    // Setter for the dirty flag
+    // Forces (true) or suppresses (false) reprocessing on the next evaluate()
     void setDirty(bool value) {
-        dirty = value;
+        if (value) {
+            markParametersChanged();
+        } else {
+            computedParamGeneration = paramGeneration;
+            computedInputGeneration = inputGeneration;
+        }
     }
 
-    // Pure virtual methods for processing and UI rendering
+    // Computes outputImage from the inputs
     virtual void process() = 0;
-    virtual void drawUI() = 0;
+
+    // Stable identifier of the node class, used in saved graphs
+    virtual const char* getTypeName() const = 0;
+
+    // Visits every saved parameter. Called with stateMutex held; after a
+    // load the caller marks the parameters changed. Loaded values are only
+    // known to be finite, so nodes bring them back into range afterwards
+    // (see clampParam()).
+    virtual void visitParams(ParamVisitor& visitor) {
+        (void)visitor;
+    }
+
+    // Limits a parameter to [lo, hi]; enums included
+    template <typename T>
+    static void clampParam(T& value, T lo, T hi) {
+        if (value < lo)
+            value = lo;
+        else if (hi < value)
+            value = hi;
+    }
+
+    // Adapts parameters measured in pixels (radii, block sizes) for running
+    // on a copy of the input scaled by 'factor', so that a low-resolution
+    // proxy looks like a downscaled full-resolution result. Called with
+    // stateMutex held, on proxy nodes only.
+    virtual void scaleParams(double factor) {
+        (void)factor;
+    }
+
+    // True once the evaluation running this node has been abandoned (see
+    // CancelToken). Long loops in process() check it and return early
+    // without publishing.
+    bool isCancelled() const {
+        return cancelToken && cancelToken->isCancelled();
+    }
+
+    // Runs 'body' over horizontal bands of about 'bandRows' of the given
+    // rows, spread across threads. Bands not yet started are skipped once
+    // the evaluation is cancelled. Returns false if it was.
+    bool forEachBand(int rows, int bandRows, const std::function<void(const cv::Range&)>& body) const {
+        int bands = std::max(1, (rows + bandRows - 1) / bandRows);
+        cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& range) {
+            for (int b = range.start; b < range.end && !isCancelled(); ++b)
+                body(cv::Range(b * rows / bands, (b + 1) * rows / bands));
+        });
+        return !isCancelled();
+    }
+
+    // 'region' grown by dx pixels left and right and dy pixels up and down,
+    // for getInputRegion() of nodes with a spatial footprint
+    static cv::Rect growRegion(const cv::Rect& region, int dx, int dy) {
+        return cv::Rect(region.x - dx, region.y - dy, region.width + 2 * dx, region.height + 2 * dy);
+    }
 
     // Node name (for display/debugging)
     std::string getNodeName() const {
@@ -50,9 +372,23 @@ public:
     cv::Mat outputImage;
     virtual void reset(){
         clearOutput();
-        dirty = true;
     }
 
-    bool dirty = true; // Indicates whether the node needs reprocessing
+    std::vector<Port> inputPorts;
+    std::vector<Port> outputPorts;
+
+    // Guards parameters and published outputs (see class comment)
+    mutable std::mutex stateMutex;
+
+    // Generation bookkeeping (see class comment)
+    std::vector<uint64_t> portGenerations; // Upstream generation held on each input port
+    uint64_t inputGeneration = 0;          // Changes whenever any input port changes
+    uint64_t paramGeneration = nextGeneration(); // Bumped on every parameter change
+    uint64_t computedInputGeneration = 0;  // inputGeneration used by the last process()
+    uint64_t computedParamGeneration = 0;  // paramGeneration used by the last process()
+    uint64_t outputGeneration = 0;         // Generation of outputImage
+    const CancelToken* cancelToken = nullptr; // Set by NodeGraph::setCancelToken()
+    std::shared_ptr<ImagePyramid> outputPyramid; // See getOutputPyramid()
+    uint64_t outputPyramidGeneration = 0;
     std::string nodeName;
-};
\ No newline at end of file
+};
@@ -0,0 +1,562 @@
+#include "NodeGraph.h"
+#include "PointProgram.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// Per-stage buffer budget for one tile, sized to stay resident in L2
+const size_t kTileBytes = 256 * 1024;
+
+cv::Rect grow(const cv::Rect& r, int halo) {
+    return cv::Rect(r.x - halo, r.y - halo, r.width + 2 * halo, r.height + 2 * halo);
+}
+
+// Pushes one tile through every stage. Each stage computes the region the
+// next one needs (its output tile grown by the next stage's halo) and the
+// result is cropped to that region before being handed on. Returns a view
+// of the last stage's output covering 'tile'.
+cv::Mat runTile(const cv::Mat& input, const std::vector<NodeBase::TileKernel>& kernels,
+                const cv::Rect& tile) {
+    cv::Rect image(0, 0, input.cols, input.rows);
+    std::vector<cv::Rect> regions(kernels.size());
+    regions.back() = tile;
+    for (size_t i = kernels.size() - 1; i > 0; --i)
+        regions[i - 1] = grow(regions[i], kernels[i].halo) & image;
+
+    cv::Rect srcRect = grow(regions[0], kernels[0].halo) & image;
+    cv::Mat src = input(srcRect);
+    cv::Point origin = srcRect.tl();
+    for (size_t i = 0; i < kernels.size(); ++i) {
+        cv::Mat dst;
+        kernels[i].apply(src, cv::Rect(origin, src.size()), dst);
+        src = dst(cv::Rect(regions[i].x - origin.x, regions[i].y - origin.y,
+                           regions[i].width, regions[i].height));
+        origin = regions[i].tl();
+    }
+    return src;
+}
+
+cv::Mat runTiles(const cv::Mat& input, const std::vector<NodeBase::TileKernel>& kernels,
+                 const CancelToken* cancel) {
+    int totalHalo = 0;
+    for (const NodeBase::TileKernel& k : kernels)
+        totalHalo += k.halo;
+
+    // Square tiles, multiples of 32 pixels; grown for large halos so the
+    // overlap stays a small fraction of each tile
+    int side = static_cast<int>(std::sqrt(double(kTileBytes) / input.elemSize()));
+    side = std::max({ 64, side / 32 * 32, (4 * totalHalo + 31) / 32 * 32 });
+    int tilesX = (input.cols + side - 1) / side;
+    int tilesY = (input.rows + side - 1) / side;
+    auto tileRect = [&](int index) {
+        int x = (index % tilesX) * side, y = (index / tilesX) * side;
+        return cv::Rect(x, y, std::min(side, input.cols - x), std::min(side, input.rows - y));
+    };
+
+    // First tile on its own: the output type is only known once a tile ran
+    cv::Mat first = runTile(input, kernels, tileRect(0));
+    cv::Mat output(input.size(), first.type());
+    cv::Mat firstDst = output(tileRect(0));
+    first.copyTo(firstDst);
+
+    cv::parallel_for_(cv::Range(1, tilesX * tilesY), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            if (cancel && cancel->isCancelled())
+                return; // The result will be thrown away
+            cv::Rect r = tileRect(i);
+            cv::Mat dst = output(r);
+            runTile(input, kernels, r).copyTo(dst);
+        }
+    });
+    return output;
+}
+
+} // namespace
+
+void NodeGraph::addNode(NodeBase& node) {
+    if (contains(&node))
+        return;
+    nodes.push_back(&node);
+    outputs[&node].resize(node.getOutputPorts().size());
+    node.cancelToken = cancelToken;
+}
+
+void NodeGraph::setCancelToken(const CancelToken* token) {
+    cancelToken = token;
+    for (NodeBase* node : nodes)
+        node->cancelToken = token;
+}
+
+bool NodeGraph::contains(const NodeBase* node) const {
+    return std::find(nodes.begin(), nodes.end(), node) != nodes.end();
+}
+
+bool NodeGraph::connect(NodeBase& source, int sourcePort, NodeBase& target, int targetPort) {
+    if (!contains(&source) || !contains(&target)) {
+        std::cerr << "NodeGraph::connect(): node not in graph" << std::endl;
+        return false;
+    }
+    if (sourcePort < 0 || sourcePort >= static_cast<int>(source.getOutputPorts().size()) ||
+        targetPort < 0 || targetPort >= static_cast<int>(target.getInputPorts().size())) {
+        std::cerr << "NodeGraph::connect(): invalid port for " << source.getNodeName()
+                  << " -> " << target.getNodeName() << std::endl;
+        return false;
+    }
+    const Port& out = source.getOutputPorts()[sourcePort];
+    const Port& in = target.getInputPorts()[targetPort];
+    if (in.type == PortType::Gray && out.type != PortType::Gray) {
+        std::cerr << "NodeGraph::connect(): " << target.getNodeName() << "." << in.name
+                  << " expects a gray image" << std::endl;
+        return false;
+    }
+    if (&source == &target || reaches(&target, &source)) {
+        std::cerr << "NodeGraph::connect(): " << source.getNodeName() << " -> "
+                  << target.getNodeName() << " would create a cycle" << std::endl;
+        return false;
+    }
+
+    disconnect(target, targetPort);
+    edges.push_back({ &source, sourcePort, &target, targetPort });
+    return true;
+}
+
+void NodeGraph::disconnect(NodeBase& target, int targetPort) {
+    edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const Edge& e) {
+                    return e.target == &target && e.targetPort == targetPort;
+                }),
+                edges.end());
+}
+
+const NodeGraph::Edge* NodeGraph::findInputEdge(const NodeBase* target, int targetPort) const {
+    for (const Edge& e : edges) {
+        if (e.target == target && e.targetPort == targetPort)
+            return &e;
+    }
+    return nullptr;
+}
+
+// True if 'to' is downstream of 'from'
+bool NodeGraph::reaches(const NodeBase* from, const NodeBase* to) const {
+    std::vector<const NodeBase*> stack = { from };
+    std::unordered_map<const NodeBase*, bool> seen;
+    while (!stack.empty()) {
+        const NodeBase* node = stack.back();
+        stack.pop_back();
+        if (node == to)
+            return true;
+        if (seen[node])
+            continue;
+        seen[node] = true;
+        for (const Edge& e : edges) {
+            if (e.source == node)
+                stack.push_back(e.target);
+        }
+    }
+    return false;
+}
+
+void NodeGraph::visit(NodeBase* node, std::vector<NodeBase*>& order,
+                      std::unordered_map<const NodeBase*, bool>& visited) const {
+    if (visited[node])
+        return;
+    visited[node] = true;
+    for (int p = 0; p < static_cast<int>(node->getInputPorts().size()); ++p) {
+        if (const Edge* e = findInputEdge(node, p))
+            visit(e->source, order, visited);
+    }
+    order.push_back(node);
+}
+
+std::vector<NodeBase*> NodeGraph::topologicalOrder(NodeBase& target) const {
+    std::vector<NodeBase*> order;
+    std::unordered_map<const NodeBase*, bool> visited;
+    if (contains(&target))
+        visit(&target, order, visited);
+    return order;
+}
+
+bool NodeGraph::propagateRegion(NodeBase& target, const cv::Rect& region,
+                                std::unordered_map<const NodeBase*, cv::Rect>& regions) const {
+    regions.clear();
+    std::vector<NodeBase*> order = topologicalOrder(target);
+    regions[&target] = region;
+    // Consumers come after their sources, so walking backwards finishes each
+    // node's region before it is translated to the node's inputs
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        NodeBase* node = *it;
+        auto found = regions.find(node);
+        if (found == regions.end())
+            continue; // Output not needed, e.g. behind a pass-through input
+        cv::Rect wanted = found->second;
+        std::lock_guard<std::mutex> lock(node->stateMutex);
+        bool passThrough = node->isPassThrough();
+        for (int p = 0; p < static_cast<int>(node->getInputPorts().size()); ++p) {
+            const Edge* e = findInputEdge(node, p);
+            if (!e || (passThrough && p != 0))
+                continue;
+            cv::Rect needed = wanted;
+            if (!passThrough && !node->getInputRegion(p, wanted, needed))
+                return false;
+            cv::Rect& source = regions[e->source];
+            source = source.empty() ? needed : (source | needed);
+        }
+    }
+    return true;
+}
+
+const NodeGraph::Buffer& NodeGraph::evaluate(NodeBase& target, int port) {
+    std::vector<NodeBase*> order = topologicalOrder(target);
+    planChains(order, target);
+    size_t width = pool ? parallelWidth(order) : 1;
+    if (width > 1 && pool->getWorkerCount() > 1) {
+        evaluateParallel(order);
+    } else {
+        for (NodeBase* node : order) {
+            if (isCancelled())
+                break;
+            evaluateNode(node);
+        }
+    }
+    return getOutput(target, port);
+}
+
+// Largest number of nodes sharing a dependency level, i.e. how many branches
+// can run at the same time. A plain chain has width 1.
+size_t NodeGraph::parallelWidth(const std::vector<NodeBase*>& order) const {
+    std::unordered_map<const NodeBase*, size_t> level;
+    std::vector<size_t> perLevel;
+    for (NodeBase* node : order) {
+        size_t l = 0;
+        for (int p = 0; p < static_cast<int>(node->getInputPorts().size()); ++p) {
+            if (const Edge* e = findInputEdge(node, p))
+                l = std::max(l, level[e->source] + 1);
+        }
+        level[node] = l;
+        if (perLevel.size() <= l)
+            perLevel.resize(l + 1, 0);
+        ++perLevel[l];
+    }
+    return perLevel.empty() ? 0 : *std::max_element(perLevel.begin(), perLevel.end());
+}
+
+void NodeGraph::evaluateParallel(const std::vector<NodeBase*>& order) {
+    // Dependency counts restricted to the requested subgraph
+    std::unordered_map<const NodeBase*, size_t> index;
+    for (size_t i = 0; i < order.size(); ++i)
+        index[order[i]] = i;
+
+    std::vector<std::atomic<int>> pending(order.size());
+    std::vector<std::vector<size_t>> dependents(order.size());
+    for (std::atomic<int>& p : pending)
+        p = 0;
+    for (const Edge& e : edges) {
+        auto s = index.find(e.source);
+        auto t = index.find(e.target);
+        if (s != index.end() && t != index.end()) {
+            dependents[s->second].push_back(t->second);
+            ++pending[t->second];
+        }
+    }
+
+    // OpenCV's thread count is left alone: it is process-wide, and other
+    // graphs may be evaluating at the same time. Its parallel_for_ doesn't
+    // oversubscribe anyway; calls made while another is running execute on
+    // the calling thread (TBB builds share one scheduler).
+
+    std::mutex doneMutex;
+    std::condition_variable done;
+    size_t remaining = order.size();
+
+    std::function<void(size_t)> run = [&](size_t i) {
+        try {
+            // Cancelled: let the remaining tasks drain without doing work
+            if (!isCancelled())
+                evaluateNode(order[i]);
+        } catch (const std::exception& e) {
+            // Includes cv::Exception and bad_alloc on huge images. Either way
+            // the bookkeeping below must run, or evaluate() waits forever.
+            std::cerr << "NodeGraph: " << order[i]->getNodeName() << " failed: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "NodeGraph: " << order[i]->getNodeName() << " failed" << std::endl;
+        }
+        for (size_t d : dependents[i]) {
+            if (--pending[d] == 0)
+                pool->submit([&run, d] { run(d); });
+        }
+        std::lock_guard<std::mutex> lock(doneMutex);
+        if (--remaining == 0)
+            done.notify_all();
+    };
+
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (pending[i] == 0)
+            pool->submit([&run, i] { run(i); });
+    }
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    done.wait(lock, [&] { return remaining == 0; });
+}
+
+const NodeGraph::Buffer& NodeGraph::getOutput(const NodeBase& node, int port) const {
+    auto it = outputs.find(&node);
+    if (it == outputs.end() || port < 0 || port >= static_cast<int>(it->second.size()))
+        return emptyBuffer;
+    return it->second[port];
+}
+
+// Splits the evaluation order into runs of nodes that can be evaluated as one
+// unit: each member (after the first) gets input 0 from the previous member's
+// output 0, which nobody else consumes. Members either tile or are point-wise;
+// only point-wise nodes may take further inputs from outside the run. Planned
+// from the nodes' current state; evaluateChain() re-checks everything.
+void NodeGraph::planChains(const std::vector<NodeBase*>& order, const NodeBase& target) {
+    std::unordered_map<const NodeBase*, Chain> previous;
+    previous.swap(chains);
+    chainInterior.clear();
+
+    std::unordered_map<const NodeBase*, int> consumers;
+    std::unordered_map<const NodeBase*, bool> sideOutputs;
+    for (const Edge& e : edges) {
+        ++consumers[e.source];
+        if (e.sourcePort != 0)
+            sideOutputs[e.source] = true;
+    }
+
+    auto chainable = [&](NodeBase* node, bool& passThrough) {
+        if (node->getInputPorts().empty() || node->getOutputPorts().empty() || sideOutputs[node])
+            return false;
+        std::lock_guard<std::mutex> lock(node->stateMutex);
+        passThrough = node->isPassThrough();
+        if (passThrough)
+            return true;
+        std::vector<NodeBase::PointOp> ops;
+        if (node->getPointOps(ops))
+            return true;
+        NodeBase::TileKernel kernel;
+        return node->getInputPorts().size() == 1 && node->getTileKernel(kernel);
+    };
+
+    std::vector<NodeBase*> run;
+    std::vector<bool> runPassThrough;
+    auto flush = [&]() {
+        // Pass-through nodes at the ends just forward buffers as usual
+        size_t begin = 0, end = run.size();
+        while (begin < end && runPassThrough[begin])
+            ++begin;
+        while (end > begin && runPassThrough[end - 1])
+            --end;
+        size_t active = 0;
+        for (size_t i = begin; i < end; ++i)
+            active += runPassThrough[i] ? 0 : 1;
+
+        // A single node gains nothing over running on its own
+        if (active >= 2) {
+            Chain chain;
+            chain.nodes.assign(run.begin() + begin, run.begin() + end);
+            NodeBase* tail = chain.nodes.back();
+            auto old = previous.find(tail);
+            if (old != previous.end() && old->second.nodes == chain.nodes)
+                chain = old->second;
+            for (NodeBase* node : chain.nodes) {
+                if (node != tail)
+                    chainInterior[node] = true;
+            }
+            chains[tail] = chain;
+        }
+        run.clear();
+        runPassThrough.clear();
+    };
+
+    for (NodeBase* node : order) {
+        bool passThrough = false;
+        if (!chainable(node, passThrough)) {
+            flush();
+            continue;
+        }
+        const Edge* e = findInputEdge(node, 0);
+        bool continues = !run.empty() && e && e->source == run.back() && e->sourcePort == 0 &&
+                         consumers[run.back()] == 1 && run.back() != &target;
+        if (!continues)
+            flush();
+        run.push_back(node);
+        runPassThrough.push_back(passThrough);
+    }
+    flush();
+}
+
+// Runs a planned chain as one unit. Consecutive point-wise members are fused
+// into a single pass (PointProgram); large images then go through the stages
+// tile by tile, smaller ones in one full-frame pass per stage. Returns false
+// if the chain has to be evaluated node by node instead: a member can't be
+// fused or tiled with its current parameters or inputs, or the image is
+// small and nothing would be fused.
+bool NodeGraph::evaluateChain(Chain& chain) {
+    NodeBase* head = chain.nodes.front();
+    NodeBase* tail = chain.nodes.back();
+    const Edge* e = findInputEdge(head, 0);
+    const Buffer& in = e ? getOutput(*e->source, e->sourcePort) : emptyBuffer;
+    if (in.image.empty())
+        return false;
+    const cv::Mat& input = in.image.read();
+    bool tiled = tilingMinPixels != 0 && input.total() >= tilingMinPixels;
+
+    // Inputs from outside the chain (e.g. a blend operand) go to the members
+    // directly, and count towards the chain's stamps
+    std::vector<uint64_t> stamps = { in.generation };
+    for (NodeBase* node : chain.nodes) {
+        const std::vector<Port>& ports = node->getInputPorts();
+        for (int p = 1; p < static_cast<int>(ports.size()); ++p) {
+            const Edge* side = findInputEdge(node, p);
+            const Buffer& buffer = side ? getOutput(*side->source, side->sourcePort) : emptyBuffer;
+            if (buffer.image.empty() && !ports[p].optional)
+                return false;
+            node->feedInput(p, buffer.image.read(), buffer.generation);
+            stamps.push_back(buffer.generation);
+        }
+    }
+
+    std::vector<NodeBase::TileKernel> stages;
+    std::unique_ptr<PointProgram> program;
+    int channels = input.channels();
+    bool eightBit = input.depth() == CV_8U; // Kept by every stage (see TileKernel)
+    size_t active = 0;
+    auto flushProgram = [&]() {
+        if (program && !program->empty())
+            stages.push_back(program->toTileKernel());
+        program.reset();
+    };
+
+    for (NodeBase* node : chain.nodes) {
+        std::lock_guard<std::mutex> lock(node->stateMutex);
+        stamps.push_back(node->paramGeneration);
+        if (node->isPassThrough())
+            continue;
+        ++active;
+
+        std::vector<NodeBase::PointOp> ops;
+        if (eightBit && node->getPointOps(ops)) {
+            if (!program)
+                program.reset(new PointProgram(input.size(), channels));
+            if (program->append(ops)) {
+                channels = program->getChannels();
+                continue;
+            }
+        }
+
+        NodeBase::TileKernel kernel;
+        if (node->getInputPorts().size() != 1 || !node->getTileKernel(kernel))
+            return false;
+        flushProgram();
+        stages.push_back(kernel);
+        if (kernel.outputChannels)
+            channels = kernel.outputChannels;
+    }
+    flushProgram();
+    if (stages.empty() || (!tiled && stages.size() >= active))
+        return false;
+
+    head->feedInput(0, input, in.generation);
+    std::vector<Buffer>& outs = outputs.find(tail)->second;
+    if (stamps == chain.stamps && !outs[0].image.empty())
+        return true;
+
+    cv::Mat result;
+    {
+        // Named after the node whose output the chain produces
+        ProfileScope scope(tail->nodeName.c_str(), tiled ? "chain (tiled)" : "chain (fused)");
+        result = tiled ? runTiles(input, stages, cancelToken)
+                       : runTile(input, stages, cv::Rect(0, 0, input.cols, input.rows));
+    }
+    if (isCancelled())
+        return true; // Unfinished; the stamps stay old so the next pass reruns it
+
+    for (NodeBase* node : chain.nodes) {
+        if (node == tail)
+            continue;
+        node->invalidateOutput();
+        for (Buffer& b : outputs.find(node)->second)
+            b = Buffer();
+    }
+    tail->setTiledOutput(result, tail == head);
+    outs[0].image = result;
+    {
+        std::lock_guard<std::mutex> lock(tail->stateMutex);
+        outs[0].generation = tail->getOutputGeneration();
+    }
+    chain.stamps = stamps;
+    return true;
+}
+
+void NodeGraph::evaluateNode(NodeBase* node) {
+    // Chain members run when their chain's last node comes up
+    if (chainInterior.count(node))
+        return;
+    auto chain = chains.find(node);
+    if (chain == chains.end()) {
+        evaluateSingle(node);
+        return;
+    }
+    if (evaluateChain(chain->second))
+        return;
+    for (NodeBase* member : chain->second.nodes)
+        evaluateSingle(member);
+}
+
+void NodeGraph::evaluateSingle(NodeBase* node) {
+    // find() rather than operator[]: may run concurrently for different nodes
+    std::vector<Buffer>& outs = outputs.find(node)->second;
+    const std::vector<Port>& ports = node->getInputPorts();
+
+    // Hand the upstream buffers to the node. A required input without an
+    // image leaves the node (and everything below it) without output.
+    bool ready = true;
+    const Buffer* firstInput = nullptr;
+    for (int p = 0; p < static_cast<int>(ports.size()); ++p) {
+        const Edge* e = findInputEdge(node, p);
+        const Buffer& in = e ? getOutput(*e->source, e->sourcePort) : emptyBuffer;
+        if (p == 0)
+            firstInput = &in;
+        if (in.image.empty() && !ports[p].optional) {
+            ready = false;
+            continue;
+        }
+        node->feedInput(p, in.image.read(), in.generation);
+    }
+
+    if (!ready) {
+        for (Buffer& b : outs)
+            b = Buffer();
+        return;
+    }
+
+    // Disabled nodes forward the input buffer untouched
+    bool passThrough;
+    {
+        std::lock_guard<std::mutex> lock(node->stateMutex);
+        passThrough = node->isPassThrough();
+    }
+    if (firstInput && passThrough) {
+        for (Buffer& b : outs)
+            b = Buffer();
+        if (!outs.empty())
+            outs[0] = *firstInput;
+        return;
+    }
+
+    node->evaluate();
+    // The UI thread may replace or release outputs meanwhile (image loads,
+    // Reset), always under the node's lock
+    std::lock_guard<std::mutex> lock(node->stateMutex);
+    for (int p = 0; p < static_cast<int>(outs.size()); ++p) {
+        outs[p].image = node->getOutput(p);
+        outs[p].generation = node->getOutputGeneration();
+    }
+}
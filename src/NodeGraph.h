@@ -0,0 +1,116 @@
+#pragma once
+#include "ImageRef.h"
+#include "NodeBase.h"
+#include "ThreadPool.h"
+#include <opencv2/core.hpp>
+#include <unordered_map>
+#include <vector>
+
+// Directed acyclic graph of processing nodes.
+//
+// Edges connect an output port of one node to an input port of another. The
+// graph does not own its nodes. Evaluating a node runs only the subgraph
+// upstream of it, in topological order, handing each output buffer (image plus
+// generation) along its edges. Nodes that report isPassThrough() forward their
+// input buffer without being processed.
+//
+// With a thread pool attached, independent branches run concurrently: a node
+// is scheduled as soon as all of its upstream nodes have completed.
+//
+// Chains of single-consumer nodes that are point-wise (NodeBase::PointOp) or
+// tileable (NodeBase::TileKernel) run as one unit. Consecutive point-wise
+// nodes are fused into a single pass over the image. Large images are pushed
+// through the chain tile by tile, so intermediates stay in cache; each stage's
+// input region is the tile grown by the halos of the stages after it. Only
+// the last node of a chain keeps an output.
+class NodeGraph {
+public:
+    struct Edge {
+        NodeBase* source;
+        int sourcePort;
+        NodeBase* target;
+        int targetPort;
+    };
+
+    // Image travelling along an edge, stamped with its generation. The pixels
+    // are shared by every consumer, never copied per edge.
+    struct Buffer {
+        ImageRef image;
+        uint64_t generation = 0;
+    };
+
+    void addNode(NodeBase& node);
+
+    // Pool used for concurrent evaluation; nullptr evaluates serially
+    void setThreadPool(ThreadPool* threadPool) { pool = threadPool; }
+    ThreadPool* getThreadPool() const { return pool; }
+
+    // Token polled during evaluation, by the graph between nodes and tiles
+    // and by the nodes themselves; nullptr makes evaluation uninterruptible.
+    // A cancelled evaluate() returns a stale or empty buffer.
+    void setCancelToken(const CancelToken* token);
+
+    // Images with at least this many pixels run chains tile by tile; 0 disables tiling
+    void setTilingThreshold(size_t minPixels) { tilingMinPixels = minPixels; }
+
+    // Connects source:sourcePort -> target:targetPort, replacing any edge
+    // already feeding that input. Fails on unknown nodes or ports, type
+    // mismatch, or if the edge would create a cycle.
+    bool connect(NodeBase& source, int sourcePort, NodeBase& target, int targetPort);
+    void disconnect(NodeBase& target, int targetPort);
+
+    const std::vector<NodeBase*>& getNodes() const { return nodes; }
+    const std::vector<Edge>& getEdges() const { return edges; }
+
+    // Edge feeding the given input port, or nullptr if unconnected
+    const Edge* findInputEdge(const NodeBase* target, int targetPort) const;
+
+    // Nodes upstream of (and including) target, dependencies first
+    std::vector<NodeBase*> topologicalOrder(NodeBase& target) const;
+
+    // Demand-driven region of interest: the part of each upstream node's
+    // output needed to compute 'region' of target's output, found by
+    // translating the region backwards through every node's footprint
+    // (NodeBase::getInputRegion). Regions aren't clipped to image bounds.
+    // Returns false if some node needs all of its input, in which case only
+    // a full-frame evaluation gives the right pixels.
+    bool propagateRegion(NodeBase& target, const cv::Rect& region,
+                         std::unordered_map<const NodeBase*, cv::Rect>& regions) const;
+
+    // Brings everything upstream of target up to date and returns its output
+    const Buffer& evaluate(NodeBase& target, int port = 0);
+
+    // Last buffer published on an output port
+    const Buffer& getOutput(const NodeBase& node, int port = 0) const;
+
+private:
+    // Run of nodes evaluated as one unit, with the input and parameter
+    // generations of its last run
+    struct Chain {
+        std::vector<NodeBase*> nodes;
+        std::vector<uint64_t> stamps;
+    };
+
+    bool isCancelled() const { return cancelToken && cancelToken->isCancelled(); }
+    bool contains(const NodeBase* node) const;
+    bool reaches(const NodeBase* from, const NodeBase* to) const;
+    void visit(NodeBase* node, std::vector<NodeBase*>& order,
+               std::unordered_map<const NodeBase*, bool>& visited) const;
+    void evaluateNode(NodeBase* node);
+    void evaluateSingle(NodeBase* node);
+    void planChains(const std::vector<NodeBase*>& order, const NodeBase& target);
+    bool evaluateChain(Chain& chain);
+    void evaluateParallel(const std::vector<NodeBase*>& order);
+    size_t parallelWidth(const std::vector<NodeBase*>& order) const;
+
+    std::vector<NodeBase*> nodes;
+    std::vector<Edge> edges;
+    std::unordered_map<const NodeBase*, std::vector<Buffer>> outputs;
+    Buffer emptyBuffer;
+    ThreadPool* pool = nullptr;
+    const CancelToken* cancelToken = nullptr;
+
+    size_t tilingMinPixels = 4 * 1024 * 1024;
+    std::unordered_map<const NodeBase*, Chain> chains;       // Keyed by last node
+    std::unordered_map<const NodeBase*, bool> chainInterior; // Run by their chain
+};
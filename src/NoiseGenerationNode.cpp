@@ -1,6 +1,6 @@
 #include "NoiseGenerationNode.h"
-#include <imgui.h>
 #include <opencv2/imgproc.hpp>
+#include <algorithm>
 #include <cmath>
 #include <random>
 
@@ -18,8 +18,7 @@ NoiseGenerationNode::NoiseGenerationNode()
 }
 
 void NoiseGenerationNode::setInputImage(const cv::Mat& image) {
-    inputImage = image.clone(); // Used if displacement is needed, or for passing through
-    dirty = true;
+    inputImage = image; // Used if displacement is needed, or for passing through
 }
 
 const cv::Mat& NoiseGenerationNode::getOutputImage() const {
@@ -28,6 +27,10 @@ const cv::Mat& NoiseGenerationNode::getOutputImage() const {
 
 // Basic Perlin-like pseudo noise for demo purposes
 float NoiseGenerationNode::generateNoiseValue(float x, float y) {
+    return generateNoiseValue(x, y, scale, octaves, persistence);
+}
+
+float NoiseGenerationNode::generateNoiseValue(float x, float y, float scale, int octaves, float persistence) {
     float value = 0.0f;
     float amplitude = 1.0f;
     float frequency = scale;
@@ -47,66 +50,67 @@ float NoiseGenerationNode::generateNoiseValue(float x, float y) {
 }
 
 void NoiseGenerationNode::process() {
+    // Snapshot parameters; the UI may edit them while we compute
+    bool enabled;
+    NoiseOutputMode mode;
+    float noiseScale, noisePersistence;
+    int noiseOctaves, w, h;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        enabled = useNoise;
+        mode = outputMode;
+        noiseScale = scale;
+        noiseOctaves = octaves;
+        noisePersistence = persistence;
+        w = width;
+        h = height;
+    }
+
     // If noise generation is not enabled, pass through the original image.
-    if (!useNoise) {
+    if (!enabled) {
         // Ensure that if an input image is available, it is passed through.
         if (!inputImage.empty()) {
-            outputImage = inputImage.clone();
+            std::lock_guard<std::mutex> lock(stateMutex);
+            outputImage = inputImage;
         }
-        dirty = false;
         return;
     }
 
-    // Otherwise generate the noise image.
-    outputImage = cv::Mat(height, width, CV_8UC1);
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            float noiseVal = generateNoiseValue(static_cast<float>(x), static_cast<float>(y));
-            outputImage.at<uchar>(y, x) = static_cast<uchar>(noiseVal * 255);
+    // Otherwise generate the noise image, a band of rows at a time so a
+    // superseded evaluation stops early.
+    cv::Mat result(h, w, CV_8UC1);
+    bool finished = forEachBand(h, 32, [&](const cv::Range& rows) {
+        for (int y = rows.start; y < rows.end; ++y) {
+            uchar* row = result.ptr<uchar>(y);
+            for (int x = 0; x < w; ++x) {
+                float noiseVal = generateNoiseValue(static_cast<float>(x), static_cast<float>(y),
+                                                    noiseScale, noiseOctaves, noisePersistence);
+                row[x] = static_cast<uchar>(noiseVal * 255);
+            }
         }
-    }
-
-    if (outputMode == NoiseOutputMode::Color) {
-        cv::cvtColor(outputImage, outputImage, cv::COLOR_GRAY2BGR);
-    }
-    dirty = false;
-}
-
-void NoiseGenerationNode::drawUI() {
-    ImGui::Text("Noise Generation Node");
-    bool changed = false;
-
-    // Checkbox to enable or disable noise generation
-    changed |= ImGui::Checkbox("Enable Noise", &useNoise);
-
-    // Noise type selection
-    const char* types[] = { "Perlin", "Simplex", "Worley" };
-    int noiseIdx = static_cast<int>(noiseType);
-    if (ImGui::Combo("Noise Type", &noiseIdx, types, IM_ARRAYSIZE(types))) {
-        noiseType = static_cast<NoiseType>(noiseIdx);
-        changed = true;
-    }
+    });
+    if (!finished)
+        return;
 
-    // Output mode
-    const char* modes[] = { "Color Output", "Displacement Map" };
-    int outputIdx = static_cast<int>(outputMode);
-    if (ImGui::Combo("Output Mode", &outputIdx, modes, IM_ARRAYSIZE(modes))) {
-        outputMode = static_cast<NoiseOutputMode>(outputIdx);
-        changed = true;
+    if (mode == NoiseOutputMode::Color) {
+        cv::cvtColor(result, result, cv::COLOR_GRAY2BGR);
     }
 
-    changed |= ImGui::SliderFloat("Scale", &scale, 0.001f, 0.1f);
-    changed |= ImGui::SliderInt("Octaves", &octaves, 1, 8);
-    changed |= ImGui::SliderFloat("Persistence", &persistence, 0.1f, 1.0f);
+    std::lock_guard<std::mutex> lock(stateMutex);
+    outputImage = result;
+}
 
-    if (changed) {
-        dirty = true;
-    }
+void NoiseGenerationNode::scaleParams(double factor) {
+    // Same pattern over fewer pixels
+    width = std::max(1, static_cast<int>(std::lround(width * factor)));
+    height = std::max(1, static_cast<int>(std::lround(height * factor)));
+    scale = static_cast<float>(scale / factor);
+}
 
-    if (dirty) {
-        process();
-    }
-    if (ImGui::Button("Reset")) {
-        reset(); // Call the reset method
-    }
-}
\ No newline at end of file
+bool NoiseGenerationNode::getInputRegion(int, const cv::Rect& outputRegion, cv::Rect& inputRegion) const {
+    // The pattern is generated at its own size, not computed from the input
+    if (useNoise)
+        return false;
+    inputRegion = outputRegion;
+    return true;
+}
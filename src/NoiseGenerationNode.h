@@ -7,12 +7,34 @@ enum class NoiseOutputMode { Color, Displacement };
 
 class NoiseGenerationNode : public NodeBase {
 public:
+    static constexpr int kMaxSize = 16384; // Largest generated image side
+
     NoiseGenerationNode();
 
     void setInputImage(const cv::Mat& image);
     const cv::Mat& getOutputImage() const ;
     void process() override;
-    void drawUI() override;
+    const char* getTypeName() const override { return "NoiseGeneration"; }
+    void visitParams(ParamVisitor& v) override {
+        v.visit("enabled", useNoise);
+        v.visit("type", noiseType);
+        v.visit("outputMode", outputMode);
+        v.visit("scale", scale);
+        v.visit("octaves", octaves);
+        v.visit("persistence", persistence);
+        v.visit("width", width);
+        v.visit("height", height);
+        clampParam(noiseType, NoiseType::Perlin, NoiseType::Worley);
+        clampParam(outputMode, NoiseOutputMode::Color, NoiseOutputMode::Displacement);
+        clampParam(scale, 1e-6f, 1.0f);
+        clampParam(octaves, 1, 16);
+        clampParam(persistence, 0.0f, 1.0f);
+        clampParam(width, 1, kMaxSize);
+        clampParam(height, 1, kMaxSize);
+    }
+    void scaleParams(double factor) override;
+    bool getInputRegion(int port, const cv::Rect& outputRegion, cv::Rect& inputRegion) const override;
+    bool isPassThrough() const override { return !useNoise; }
     void reset() override {
         NodeBase::reset();
         useNoise = false; // Reset to default state
@@ -26,9 +48,6 @@ public:
     }
 
     // All members are public per your earlier request
-    cv::Mat outputImage;
-    cv::Mat inputImage;
-
     bool useNoise;  // New toggle flag: if false, passes input image through
 
     NoiseType noiseType;
@@ -41,4 +60,6 @@ public:
     int height;
 
     float generateNoiseValue(float x, float y); // Simulated Perlin-style noise
+    // Same, with explicit parameters (safe to call while the UI edits members)
+    static float generateNoiseValue(float x, float y, float scale, int octaves, float persistence);
 };
\ No newline at end of file
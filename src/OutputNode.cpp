@@ -1,5 +1,4 @@
 #include "OutputNode.h"
-#include <imgui.h>
 #include <opencv2/opencv.hpp>
 #include <iostream>
 
@@ -11,24 +10,8 @@ OutputNode::OutputNode()
 void OutputNode::process() {
     // For an output node, we simply pass the input image to the output.
     if (!inputImage.empty()) {
-        outputImage = inputImage.clone();
-    }
-}
-
-void OutputNode::drawUI() {
-    ImGui::Text("Output Node");
-
-    if (ImGui::Button("Save Output")) {
-        saveImage("C:\\Users\\jatin\\OneDrive\\Pictures\\output.png"); // or let user choose path later
-    }
-
-    if (!outputImage.empty()) {
-        ImGui::Text("Output image available.");
-        // Optional preview
-        // GLuint textureID = cvMatToTexture(outputImage, existingTextureID);
-        // ImGui::Image((ImTextureID)(uintptr_t)textureID, ImVec2(...));
-    } else {
-        ImGui::Text("No output image available.");
+        std::lock_guard<std::mutex> lock(stateMutex);
+        outputImage = inputImage; // Shared, not copied
     }
 }
 
@@ -36,7 +19,8 @@ void OutputNode::setInputImage(const cv::Mat& image) {
     // Set the inherited inputImage.
     inputImage = image;
     // Optionally update outputImage immediately.
-    outputImage = image.clone();
+    std::lock_guard<std::mutex> lock(stateMutex);
+    outputImage = image;
 }
 
 const cv::Mat& OutputNode::getOutputImage() const {
@@ -44,12 +28,22 @@ const cv::Mat& OutputNode::getOutputImage() const {
 }
 
 void OutputNode::saveImage(const std::string& filePath) {
-    outputImage = inputImage.clone(); // Ensure outputImage is set before saving
-    if (outputImage.empty()) {
+    // Take a reference to the last published output; the evaluation thread
+    // may replace it while we encode.
+    cv::Mat image;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        image = outputImage;
+    }
+    writeImage(image, filePath);
+}
+
+void OutputNode::writeImage(const cv::Mat& image, const std::string& filePath) {
+    if (image.empty()) {
         std::cerr << "No output image to save." << std::endl;
         return;
     }
-    if (!cv::imwrite(filePath, outputImage)) {
+    if (!cv::imwrite(filePath, image)) {
         std::cerr << "Failed to save image to " << filePath << std::endl;
     } else {
         std::cout << "Image saved to " << filePath << std::endl;
@@ -1,6 +1,5 @@
 #pragma once
 #include "NodeBase.h"
-#include <imgui.h>
 #include <opencv2/opencv.hpp>
 #include <string>
 
@@ -8,12 +7,20 @@ class OutputNode : public NodeBase {
 public:
     OutputNode();
     void process() override;
-    void drawUI() override;
+    const char* getTypeName() const override { return "Output"; }
+    friend class NodePanels; // Property panel, drawn by the GUI
+    bool getInputRegion(int, const cv::Rect& outputRegion, cv::Rect& inputRegion) const override {
+        inputRegion = outputRegion; // Copies its input
+        return true;
+    }
     
     // Use the inherited inputImage/outputImage from NodeBase.
     void setInputImage(const cv::Mat& image);
     const cv::Mat& getOutputImage() const;
 
     void saveImage(const std::string& filePath);
+
+private:
+    static void writeImage(const cv::Mat& image, const std::string& filePath);
 };
 
@@ -0,0 +1,223 @@
+#include "Pipeline.h"
+#include "BrightnessContrastNode.h"
+#include "ColorChannelSplitterNode.h"
+#include "BlurNode.h"
+#include "BlendNode.h"
+#include "ThresholdNode.h"
+#include "NoiseGenerationNode.h"
+#include "EdgeDetectionNode.h"
+#include "ConvolutionFilterNode.h"
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+
+namespace {
+
+// Copies a node's parameters into a GraphDesc::Node
+class ParamWriter : public ParamVisitor {
+public:
+    explicit ParamWriter(GraphDesc::Node& node) : node(node) {}
+
+    void visit(const char* name, int& value) override { add(name, { static_cast<float>(value) }); }
+    void visit(const char* name, float& value) override { add(name, { value }); }
+    void visit(const char* name, bool& value) override { add(name, { value ? 1.0f : 0.0f }); }
+    void visit(const char* name, std::vector<float>& values) override { add(name, values); }
+    using ParamVisitor::visit;
+
+private:
+    void add(const char* name, const std::vector<float>& values) {
+        node.params.push_back({ name, values });
+    }
+    GraphDesc::Node& node;
+};
+
+// Assigns saved values to a node's parameters. Parameters missing from the
+// file keep their defaults; single values with the wrong count, NaN or
+// infinite values and integers out of int's range are ignored with a
+// warning. Ranges specific to a parameter are left to the node's
+// visitParams().
+class ParamReader : public ParamVisitor {
+public:
+    explicit ParamReader(const GraphDesc::Node& node) : node(node) {}
+
+    void visit(const char* name, int& value) override {
+        const GraphDesc::Param* p = find(name, true);
+        if (!p)
+            return;
+        // Beyond +-2^31 the conversion would be undefined
+        double v = std::round(p->values[0]);
+        if (v < std::numeric_limits<int>::min() || v > std::numeric_limits<int>::max())
+            reject(name);
+        else
+            value = static_cast<int>(v);
+    }
+    void visit(const char* name, float& value) override {
+        if (const GraphDesc::Param* p = find(name, true))
+            value = p->values[0];
+    }
+    void visit(const char* name, bool& value) override {
+        if (const GraphDesc::Param* p = find(name, true))
+            value = p->values[0] != 0.0f;
+    }
+    void visit(const char* name, std::vector<float>& values) override {
+        if (const GraphDesc::Param* p = find(name, false))
+            values = p->values;
+    }
+    using ParamVisitor::visit;
+
+private:
+    const GraphDesc::Param* find(const char* name, bool scalar) const {
+        for (const GraphDesc::Param& param : node.params) {
+            if (param.name != name)
+                continue;
+            if (scalar && param.values.size() != 1)
+                return nullptr;
+            for (float v : param.values) {
+                if (!std::isfinite(v)) {
+                    reject(name);
+                    return nullptr;
+                }
+            }
+            return &param;
+        }
+        return nullptr;
+    }
+    void reject(const char* name) const {
+        std::cerr << "Graph: ignoring invalid value of " << node.type << "." << name << std::endl;
+    }
+    const GraphDesc::Node& node;
+};
+
+} // namespace
+
+std::unique_ptr<Pipeline> Pipeline::createDefault() {
+    std::unique_ptr<Pipeline> pipeline = std::make_unique<Pipeline>();
+    Pipeline& p = *pipeline;
+
+    p.input = &p.add(std::make_unique<ImageInputNode>());
+    NodeBase* chain[] = {
+        p.input,
+        &p.add(std::make_unique<BrightnessContrastNode>()),
+        &p.add(std::make_unique<ColorChannelSplitterNode>()),
+        &p.add(std::make_unique<BlurNode>()),
+        &p.add(std::make_unique<BlendNode>()),
+        &p.add(std::make_unique<ThresholdNode>()),
+        &p.add(std::make_unique<NoiseGenerationNode>()),
+        &p.add(std::make_unique<EdgeDetectionNode>()),
+        &p.add(std::make_unique<ConvolutionFilterNode>()),
+        &p.add(std::make_unique<OutputNode>())
+    };
+    p.output = static_cast<OutputNode*>(chain[sizeof(chain) / sizeof(chain[0]) - 1]);
+
+    for (size_t i = 0; i + 1 < sizeof(chain) / sizeof(chain[0]); ++i)
+        p.graph.connect(*chain[i], 0, *chain[i + 1], 0);
+    p.graph.connect(*chain[0], 0, *chain[4], 1); // Blend B <- Input
+    return pipeline;
+}
+
+cv::Mat Pipeline::process(const cv::Mat& image) {
+    if (!input || !output) {
+        std::cerr << "Pipeline::process(): pipeline has no input or output node" << std::endl;
+        return cv::Mat();
+    }
+    input->setInputImage(image);
+    return graph.evaluate(*output).image.read();
+}
+
+cv::Mat Pipeline::processRegion(const cv::Mat& image, const cv::Rect& region) {
+    if (!input || !output) {
+        std::cerr << "Pipeline::processRegion(): pipeline has no input or output node" << std::endl;
+        return cv::Mat();
+    }
+    cv::Rect bounds(cv::Point(), image.size());
+    cv::Rect wanted = region & bounds;
+    if (wanted.empty()) {
+        std::cerr << "Pipeline::processRegion(): region lies outside the image" << std::endl;
+        return cv::Mat();
+    }
+
+    // Footprints depend on parameters only, except for resizes (Blend),
+    // which read the sizes of the inputs the nodes last saw
+    std::unordered_map<const NodeBase*, cv::Rect> regions;
+    cv::Rect crop = bounds;
+    if (graph.propagateRegion(*output, wanted, regions) && regions.count(input))
+        crop = regions[input] & bounds;
+
+    cv::Mat result = process(image(crop));
+    if (result.size() == crop.size())
+        return result(wanted - crop.tl());
+    // Output geometry unrelated to the input's: no part of it matches the
+    // region, so hand back the whole frame
+    return crop == bounds ? result : process(image);
+}
+
+std::unique_ptr<NodeBase> Pipeline::createNode(const std::string& type) {
+    if (type == "ImageInput") return std::make_unique<ImageInputNode>();
+    if (type == "BrightnessContrast") return std::make_unique<BrightnessContrastNode>();
+    if (type == "ColorChannelSplitter") return std::make_unique<ColorChannelSplitterNode>();
+    if (type == "Blur") return std::make_unique<BlurNode>();
+    if (type == "Blend") return std::make_unique<BlendNode>();
+    if (type == "Threshold") return std::make_unique<ThresholdNode>();
+    if (type == "NoiseGeneration") return std::make_unique<NoiseGenerationNode>();
+    if (type == "EdgeDetection") return std::make_unique<EdgeDetectionNode>();
+    if (type == "ConvolutionFilter") return std::make_unique<ConvolutionFilterNode>();
+    if (type == "Output") return std::make_unique<OutputNode>();
+    return nullptr;
+}
+
+std::unique_ptr<Pipeline> Pipeline::create(const GraphDesc& desc) {
+    std::unique_ptr<Pipeline> pipeline = std::make_unique<Pipeline>();
+    Pipeline& p = *pipeline;
+
+    for (const GraphDesc::Node& nodeDesc : desc.nodes) {
+        std::unique_ptr<NodeBase> node = createNode(nodeDesc.type);
+        if (!node) {
+            std::cerr << "Pipeline::create(): unknown node type '" << nodeDesc.type << "'" << std::endl;
+            return nullptr;
+        }
+        applyParams(*node, nodeDesc);
+
+        NodeBase& added = p.add(std::move(node));
+        if (!p.input)
+            p.input = dynamic_cast<ImageInputNode*>(&added);
+        if (!p.output)
+            p.output = dynamic_cast<OutputNode*>(&added);
+    }
+
+    for (const GraphDesc::Link& link : desc.links) {
+        NodeBase& source = *p.nodes[link.source];
+        NodeBase& target = *p.nodes[link.target];
+        if (!p.graph.connect(source, link.sourcePort, target, link.targetPort))
+            return nullptr; // connect() reports the reason
+    }
+
+    if (!p.input || !p.output) {
+        std::cerr << "Pipeline::create(): graph needs an ImageInput and an Output node" << std::endl;
+        return nullptr;
+    }
+    return pipeline;
+}
+
+GraphDesc Pipeline::describe() const {
+    GraphDesc desc;
+    std::unordered_map<const NodeBase*, int> index;
+    for (const std::unique_ptr<NodeBase>& node : nodes) {
+        index[node.get()] = static_cast<int>(desc.nodes.size());
+        desc.nodes.push_back({ node->getTypeName(), {} });
+
+        ParamWriter writer(desc.nodes.back());
+        std::lock_guard<std::mutex> lock(node->stateMutex);
+        node->visitParams(writer);
+    }
+    for (const NodeGraph::Edge& edge : graph.getEdges())
+        desc.links.push_back({ index[edge.source], edge.sourcePort, index[edge.target], edge.targetPort });
+    return desc;
+}
+
+void Pipeline::applyParams(NodeBase& node, const GraphDesc::Node& desc) {
+    ParamReader reader(desc);
+    std::lock_guard<std::mutex> lock(node.stateMutex);
+    node.visitParams(reader);
+    node.markParametersChanged();
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "NodeGraph.h"
+#include "GraphFile.h"
+#include "ImageInputNode.h"
+#include "OutputNode.h"
+#include <opencv2/core.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A node graph together with the nodes it runs.
+//
+// NodeGraph doesn't own its nodes; a Pipeline does, so independent copies of
+// the same processing chain can exist side by side (e.g. one per batch
+// worker). The pipeline's source is its ImageInputNode and its result is the
+// OutputNode's output.
+class Pipeline {
+public:
+    // Input -> Brightness/Contrast -> Channel Splitter -> Blur -> Blend (with Input)
+    //       -> Threshold -> Noise -> Edge Detection -> Convolution -> Output
+    static std::unique_ptr<Pipeline> createDefault();
+
+    // Builds the nodes and connections of a saved graph. Returns nullptr if a
+    // node type is unknown, a connection is invalid, or the graph lacks an
+    // input or output node.
+    static std::unique_ptr<Pipeline> create(const GraphDesc& desc);
+
+    // New node of the given NodeBase::getTypeName(), or nullptr if unknown
+    static std::unique_ptr<NodeBase> createNode(const std::string& type);
+
+    // Current nodes, parameters and connections, for saving
+    GraphDesc describe() const;
+
+    // Sets the node's parameters from a saved description and marks them
+    // changed. Takes the node's stateMutex.
+    static void applyParams(NodeBase& node, const GraphDesc::Node& desc);
+
+    // Takes ownership of the node and adds it to the graph
+    template <typename T>
+    T& add(std::unique_ptr<T> node) {
+        T& ref = *node;
+        graph.addNode(ref);
+        nodes.push_back(std::move(node));
+        return ref;
+    }
+
+    // Runs an image through the graph without a background thread and
+    // returns the output (empty if the graph produced nothing)
+    cv::Mat process(const cv::Mat& image);
+
+    // Like process(), but returns only 'region' of the output and computes
+    // little more than that: the input is cropped to the part the region
+    // depends on (see NodeGraph::propagateRegion). Falls back to the full
+    // frame when some node needs its whole input, and returns the whole
+    // output if it doesn't have the input's geometry.
+    cv::Mat processRegion(const cv::Mat& image, const cv::Rect& region);
+
+    NodeGraph& getGraph() { return graph; }
+    const std::vector<std::unique_ptr<NodeBase>>& getNodes() const { return nodes; }
+    ImageInputNode* getInput() const { return input; }
+    OutputNode* getOutput() const { return output; }
+
+private:
+    std::vector<std::unique_ptr<NodeBase>> nodes;
+    NodeGraph graph;
+    ImageInputNode* input = nullptr;
+    OutputNode* output = nullptr;
+};
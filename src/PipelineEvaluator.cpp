@@ -0,0 +1,236 @@
+#include "PipelineEvaluator.h"
+#include <cmath>
+#include <iostream>
+
+PipelineEvaluator::PipelineEvaluator(NodeGraph& graph, NodeBase& target)
+    : graph(graph), target(target) {
+    graph.setCancelToken(&cancel);
+}
+
+PipelineEvaluator::~PipelineEvaluator() {
+    stop();
+    graph.setCancelToken(nullptr);
+}
+
+void PipelineEvaluator::start() {
+    if (worker.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = false;
+    }
+    worker = std::thread(&PipelineEvaluator::run, this);
+    requestEvaluation();
+}
+
+void PipelineEvaluator::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    if (worker.joinable())
+        worker.join();
+}
+
+void PipelineEvaluator::requestEvaluation(NodeBase* changedNode) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        events.push_back({ changedNode });
+        // The pass in progress is stale now; the new event gets its own
+        if (cancellable)
+            cancel.cancel();
+    }
+    wakeUp.notify_one();
+}
+
+void PipelineEvaluator::evaluateWhole() {
+    bool running = worker.joinable();
+    stop();
+    cancel.reset();
+    // Runs on the UI thread: nothing may escape, and the worker must be
+    // restarted whatever happened
+    try {
+        graph.evaluate(target);
+    } catch (const std::exception& e) {
+        std::cerr << "PipelineEvaluator: evaluation failed: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "PipelineEvaluator: evaluation failed" << std::endl;
+    }
+    if (running)
+        start();
+}
+
+void PipelineEvaluator::setViewport(const cv::Rect& region, double scale) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (region == viewport.region && scale == viewport.scale)
+            return;
+        viewport.region = region;
+        viewport.scale = scale;
+    }
+    requestEvaluation();
+}
+
+std::shared_ptr<const PipelineEvaluator::Frame> PipelineEvaluator::getLatestFrame() const {
+    return std::atomic_load(&frontFrame);
+}
+
+std::shared_ptr<const PipelineEvaluator::Frame> PipelineEvaluator::getDetailFrame() const {
+    return std::atomic_load(&detailFrame);
+}
+
+bool PipelineEvaluator::isBusy() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return evaluating || !events.empty();
+}
+
+void PipelineEvaluator::enableProxy(Pipeline& source) {
+    proxy = std::make_unique<ProxyPipeline>(source);
+    detail = std::make_unique<ProxyPipeline>(source);
+    detail->setCancelToken(&cancel); // Full-resolution work, like the graph
+}
+
+void PipelineEvaluator::run() {
+    while (true) {
+        bool interactive;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            auto hasWork = [this] { return stopping || !events.empty(); };
+            if (refinePending) {
+                // Keep answering on the proxy while changes keep coming
+                interactive = wakeUp.wait_for(lock, refineDelay, hasWork);
+            } else {
+                wakeUp.wait(lock, hasWork);
+                interactive = true;
+            }
+            if (stopping)
+                return;
+            // One evaluation covers every change queued so far; nodes that
+            // didn't change are skipped by their generation check.
+            events.clear();
+            cancel.reset();
+            evaluating = true;
+        }
+
+        try {
+            // Falls through to full resolution when the proxy has nothing
+            // new to show (no proxy, small image, no visible change)
+            if (!interactive || !evaluateProxy())
+                evaluateFull();
+        } catch (const std::exception& e) {
+            // cv::Exception, or bad_alloc on a large image; either way the
+            // thread must survive and drop the unfinished pass
+            std::cerr << "PipelineEvaluator: evaluation failed: " << e.what() << std::endl;
+            abandonPass();
+        } catch (...) {
+            std::cerr << "PipelineEvaluator: evaluation failed" << std::endl;
+            abandonPass();
+        }
+
+        evaluating = false;
+    }
+}
+
+void PipelineEvaluator::abandonPass() {
+    refinePending = false;
+    std::lock_guard<std::mutex> lock(queueMutex);
+    cancellable = false;
+}
+
+bool PipelineEvaluator::evaluateProxy() {
+    if (!proxy || !proxy->update(proxyWidth))
+        return false;
+    const NodeGraph::Buffer& out = proxy->evaluate();
+    if (out.generation == proxyGeneration)
+        return false;
+    proxyGeneration = out.generation;
+    // Output of another size (e.g. generated noise) stands for its own
+    // full-resolution size
+    const cv::Mat& image = out.image.read();
+    double scale = proxy->getScale();
+    cv::Rect region = proxy->getRegion();
+    if (proxy->getOutputRect(image).empty()) {
+        region = cv::Rect(0, 0, static_cast<int>(std::lround(image.cols / scale)),
+                          static_cast<int>(std::lround(image.rows / scale)));
+    }
+    publish(out, true, region, scale);
+    refinePending = true;
+    return true;
+}
+
+void PipelineEvaluator::evaluateFull() {
+    Viewport view;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        // Changes queued since this pass began would make it stale at once
+        if (!events.empty())
+            return;
+        cancellable = true;
+        view = viewport;
+    }
+    // Only what is on screen, if that's less than everything
+    bool detailed = evaluateDetail(view);
+    const NodeGraph::Buffer* out = detailed ? nullptr : &graph.evaluate(target);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        cancellable = false;
+    }
+    if (cancel.isCancelled())
+        return; // Superseded; the change that cancelled it is queued
+    if (out) {
+        refinePending = false;
+        publish(*out, false, cv::Rect(0, 0, out->image.read().cols, out->image.read().rows), 1.0);
+    }
+}
+
+// Renders the viewport on the detail pipeline. Returns false if the whole
+// image has to be rendered instead: no viewport, all of the image visible,
+// or a node that can't run on a crop.
+bool PipelineEvaluator::evaluateDetail(const Viewport& view) {
+    if (!detail || view.scale <= 0.0 || view.region.empty())
+        return false;
+    if (!detail->updateRegion(view.region, view.scale))
+        return false;
+    std::shared_ptr<const Frame> whole = std::atomic_load(&frontFrame);
+    if (whole && detail->getRegion() == whole->region)
+        return false;
+
+    const NodeGraph::Buffer& out = detail->evaluate();
+    if (cancel.isCancelled())
+        return true;
+    cv::Rect inOutput = detail->getOutputRect(out.image.read());
+    if (inOutput.empty())
+        return false;
+
+    auto frame = std::make_shared<Frame>();
+    frame->image = out.image.read()(inOutput);
+    frame->generation = out.generation;
+    frame->pyramid = std::make_shared<ImagePyramid>(frame->image.read());
+    frame->region = detail->getRegion();
+    frame->scale = detail->getScale();
+    std::atomic_store(&detailFrame, std::shared_ptr<const Frame>(std::move(frame)));
+    refinePending = false;
+    return true;
+}
+
+void PipelineEvaluator::publish(const NodeGraph::Buffer& out, bool isProxy,
+                                const cv::Rect& region, double scale) {
+    std::shared_ptr<const Frame> current = std::atomic_load(&frontFrame);
+    if (current && current->generation == out.generation)
+        return;
+    // A new whole-image frame supersedes any detail drawn over the old one
+    std::atomic_store(&detailFrame, std::shared_ptr<const Frame>());
+    // Fill the back frame, then swap it in
+    auto back = std::make_shared<Frame>();
+    back->image = out.image;
+    back->generation = out.generation;
+    back->proxy = isProxy;
+    back->region = region;
+    back->scale = scale;
+    back->pyramid = std::make_shared<ImagePyramid>(out.image.read());
+    int width = proxyWidth;
+    if (width > 0 && !out.image.empty())
+        back->pyramid->forWidth(width);
+    std::atomic_store(&frontFrame, std::shared_ptr<const Frame>(std::move(back)));
+}
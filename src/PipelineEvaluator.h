@@ -0,0 +1,130 @@
+#pragma once
+#include "CancelToken.h"
+#include "NodeGraph.h"
+#include "ProxyPipeline.h"
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Runs graph evaluation on a background thread.
+//
+// The UI posts change events (parameter edits, newly loaded images) and keeps
+// drawing; the worker drains all pending events, evaluates the graph once and
+// publishes the finished output. A change arriving while a full-resolution
+// pass runs cancels that pass (see CancelToken), so a slider drag never
+// waits for renders of values that were already replaced. Results are double
+// buffered: the worker fills a fresh frame and swaps it in atomically, so the
+// UI always reads the last completed result without waiting.
+//
+// With a proxy enabled, changes are first evaluated on a downscaled copy of
+// the pipeline sized to the preview, so dragging a slider gives quick
+// feedback even on large images. Once no change has arrived for the refine
+// delay, the full-resolution graph is evaluated and replaces the proxy frame.
+// When the viewer shows only part of the image (see setViewport), the refine
+// pass renders just that part, at the viewer's resolution or full resolution
+// whichever is lower, as a detail frame drawn over the whole-image frame.
+class PipelineEvaluator {
+public:
+    // A completed evaluation of the target node
+    struct Frame {
+        ImageRef image;
+        uint64_t generation = 0;
+        bool proxy = false; // Low-resolution stand-in, full resolution pending
+        // Pyramid of 'image'; levels down to the proxy width are built
+        // before the frame is published, so previews never resize from
+        // full resolution on the UI thread
+        std::shared_ptr<ImagePyramid> pyramid;
+        cv::Rect region;    // Part of the full-resolution output shown, in its pixels
+        double scale = 1.0; // Frame pixels per full-resolution pixel
+    };
+
+    PipelineEvaluator(NodeGraph& graph, NodeBase& target);
+    ~PipelineEvaluator();
+
+    void start();
+    void stop();
+
+    // Evaluates changes on a proxy of 'source' (the pipeline owning the
+    // graph) before refining at full resolution. Call before start().
+    void enableProxy(Pipeline& source);
+
+    // Width of the preview the proxy should cover, in pixels; 0 disables
+    // proxies. Published frames get pyramid levels down to this width.
+    // Safe to call from any thread.
+    void setProxyWidth(int width) { proxyWidth = width; }
+
+    // Brings the whole output up to date on the calling thread, e.g. before
+    // saving it, since refinement may have rendered only the viewport. The
+    // worker is paused meanwhile.
+    void evaluateWhole();
+
+    // Part of the output on screen (full-resolution pixels) and screen
+    // pixels per output pixel. A change queues a re-check. Safe to call from
+    // any thread, e.g. every UI frame.
+    void setViewport(const cv::Rect& region, double scale);
+
+    // Quiet time after the last change before the full-resolution render
+    void setRefineDelay(std::chrono::milliseconds delay) { refineDelay = delay; }
+
+    // Queues a change event for the given node (nullptr: full re-check)
+    void requestEvaluation(NodeBase* changedNode = nullptr);
+
+    // Last finished frame of the whole output; never blocks. May be nullptr
+    // before the first run.
+    std::shared_ptr<const Frame> getLatestFrame() const;
+
+    // Refined render of the viewport, newer than getLatestFrame(); nullptr
+    // if there is none or the whole-image frame replaced it
+    std::shared_ptr<const Frame> getDetailFrame() const;
+
+    // True while the whole-image frame is a proxy awaiting refinement
+    bool isRefining() const { return refinePending; }
+
+    // True while the worker is evaluating or has events queued
+    bool isBusy() const;
+
+private:
+    struct ChangeEvent {
+        NodeBase* node;
+    };
+
+    struct Viewport {
+        cv::Rect region;
+        double scale = 0.0; // 0: unknown, refine the whole image
+    };
+
+    void run();
+    void abandonPass(); // After a failed evaluation: no refinement, nothing to cancel
+    bool evaluateProxy();
+    void evaluateFull();
+    bool evaluateDetail(const Viewport& view);
+    void publish(const NodeGraph::Buffer& out, bool proxy, const cv::Rect& region, double scale);
+
+    NodeGraph& graph;
+    NodeBase& target;
+
+    std::thread worker;
+    mutable std::mutex queueMutex;
+    std::condition_variable wakeUp;
+    std::deque<ChangeEvent> events;
+    bool stopping = false;
+    std::atomic<bool> evaluating{false};
+    bool cancellable = false; // A full-resolution pass is running; guarded by queueMutex
+    CancelToken cancel;
+    Viewport viewport; // Guarded by queueMutex
+
+    std::unique_ptr<ProxyPipeline> proxy;  // Worker thread only, after start()
+    std::unique_ptr<ProxyPipeline> detail; // Viewport renders, same
+    std::atomic<int> proxyWidth{0};
+    std::chrono::milliseconds refineDelay{200};
+    std::atomic<bool> refinePending{false}; // Last frame came from the proxy
+    uint64_t proxyGeneration = 0; // Proxy output last published
+
+    std::shared_ptr<const Frame> frontFrame;  // Accessed with std::atomic_load/store
+    std::shared_ptr<const Frame> detailFrame; // Same
+};
@@ -0,0 +1,122 @@
+#include "PointProgram.h"
+#include <algorithm>
+#include <memory>
+
+PointProgram::PointProgram(cv::Size size, int channels)
+    : size(size), inputChannels(channels), channels(channels) {}
+
+bool PointProgram::append(const std::vector<NodeBase::PointOp>& ops) {
+    std::vector<Step> added = steps;
+    int ch = channels;
+
+    for (const NodeBase::PointOp& op : ops) {
+        switch (op.kind) {
+            case NodeBase::PointOp::Lut: {
+                if (op.tables.empty() || (op.channels && op.channels != ch))
+                    return false;
+                if (op.tables.size() != 1 && static_cast<int>(op.tables.size()) != ch)
+                    return false;
+
+                // Fold into a directly preceding lookup: one table per channel
+                // maps the original sample straight to the final one
+                if (!added.empty() && added.back().op.kind == NodeBase::PointOp::Lut) {
+                    NodeBase::PointOp& prev = added.back().op;
+                    size_t count = std::max(prev.tables.size(), op.tables.size());
+                    std::vector<std::array<uchar, 256>> composed(count);
+                    for (size_t c = 0; c < count; ++c) {
+                        const std::array<uchar, 256>& first = prev.tables[prev.tables.size() == 1 ? 0 : c];
+                        const std::array<uchar, 256>& second = op.tables[op.tables.size() == 1 ? 0 : c];
+                        for (int v = 0; v < 256; ++v)
+                            composed[c][v] = second[first[v]];
+                    }
+                    prev.tables.swap(composed);
+                } else {
+                    added.push_back({ op, ch });
+                }
+                break;
+            }
+            case NodeBase::PointOp::Gray:
+                if (ch == 1)
+                    break; // Already gray
+                if (ch != 3)
+                    return false;
+                added.push_back({ op, ch });
+                ch = 1;
+                break;
+            case NodeBase::PointOp::Blend:
+                if (!op.blendRow || op.operand.size() != size || op.operand.type() != CV_8UC(ch))
+                    return false;
+                added.push_back({ op, ch });
+                break;
+        }
+    }
+
+    steps.swap(added);
+    channels = ch;
+    return true;
+}
+
+void PointProgram::run(const cv::Mat& src, const cv::Rect& region, cv::Mat& dst) const {
+    CV_Assert(src.depth() == CV_8U && src.channels() == inputChannels);
+    if (steps.empty()) {
+        src.copyTo(dst);
+        return;
+    }
+    dst.create(src.size(), CV_8UC(channels));
+
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& rows) {
+        // Row buffers for intermediate steps, small enough to stay in L1/L2
+        std::vector<uchar> buffers[2];
+        for (std::vector<uchar>& b : buffers)
+            b.resize(static_cast<size_t>(src.cols) * inputChannels); // Steps never add channels
+
+        for (int y = rows.start; y < rows.end; ++y) {
+            const uchar* in = src.ptr<uchar>(y);
+            for (size_t i = 0; i < steps.size(); ++i) {
+                const NodeBase::PointOp& op = steps[i].op;
+                int ch = steps[i].channels;
+                uchar* out = i + 1 == steps.size() ? dst.ptr<uchar>(y) : buffers[i % 2].data();
+                int samples = src.cols * ch;
+
+                switch (op.kind) {
+                    case NodeBase::PointOp::Lut:
+                        if (op.tables.size() == 1) {
+                            const uchar* t = op.tables[0].data();
+                            for (int k = 0; k < samples; ++k)
+                                out[k] = t[in[k]];
+                        } else {
+                            for (int k = 0; k < samples; k += ch) {
+                                for (int c = 0; c < ch; ++c)
+                                    out[k + c] = op.tables[c][in[k + c]];
+                            }
+                        }
+                        break;
+                    case NodeBase::PointOp::Gray:
+                        // Fixed-point BT.601 weights with 14-bit shift, as cv::cvtColor
+                        for (int x = 0; x < src.cols; ++x) {
+                            const uchar* p = in + x * 3;
+                            out[x] = static_cast<uchar>((p[0] * 1868 + p[1] * 9617 + p[2] * 4899 + (1 << 13)) >> 14);
+                        }
+                        break;
+                    case NodeBase::PointOp::Blend: {
+                        const uchar* b = op.operand.ptr<uchar>(region.y + y) + region.x * ch;
+                        op.blendRow(in, b, out, samples, op.weight);
+                        break;
+                    }
+                }
+                in = out;
+            }
+        }
+    });
+}
+
+NodeBase::TileKernel PointProgram::toTileKernel() const {
+    std::shared_ptr<const PointProgram> program = std::make_shared<PointProgram>(*this);
+    NodeBase::TileKernel kernel;
+    kernel.halo = 0;
+    kernel.outputChannels = channels;
+    kernel.apply = [program](const cv::Mat& src, const cv::Rect& region, cv::Mat& dst) {
+        program->run(src, region, dst);
+    };
+    return kernel;
+}
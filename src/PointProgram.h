@@ -0,0 +1,43 @@
+#pragma once
+#include "NodeBase.h"
+#include <opencv2/core.hpp>
+#include <vector>
+
+// Point-wise steps of several nodes (NodeBase::PointOp) fused into one pass.
+//
+// Each row is read once, pushed through every step in a small row buffer and
+// written once, instead of every node materializing a full image. Adjacent
+// table lookups are composed into a single table per channel, so e.g.
+// brightness/contrast followed by channel masking costs one lookup per
+// sample. 8-bit images only.
+class PointProgram {
+public:
+    // Input images will be 'size' with 'channels' 8-bit channels
+    PointProgram(cv::Size size, int channels);
+
+    // Adds a node's steps after the current ones. Returns false, leaving the
+    // program unchanged, if they don't fit (channel count, operand size).
+    bool append(const std::vector<NodeBase::PointOp>& ops);
+
+    bool empty() const { return steps.empty(); }
+
+    // Channel count of the result
+    int getChannels() const { return channels; }
+
+    // Runs the program on src, which sits at 'region' of the full image
+    void run(const cv::Mat& src, const cv::Rect& region, cv::Mat& dst) const;
+
+    // The program as a single halo-free stage for NodeGraph's chains
+    NodeBase::TileKernel toTileKernel() const;
+
+private:
+    struct Step {
+        NodeBase::PointOp op;
+        int channels; // Channel count of the step's input
+    };
+
+    cv::Size size;
+    int inputChannels;
+    int channels;
+    std::vector<Step> steps;
+};
@@ -0,0 +1,256 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PRESET_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// Same scheme as BlendKernels: SIMD paths carry their own target attribute
+// and are picked at runtime
+#if defined(PRESET_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PRESET_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PRESET_TARGET(isa)
+#endif
+
+// Integer convolution kernels for ConvolutionFilterNode's presets.
+//
+// Each preset is a small kernel of integer coefficients known at compile
+// time, so its 8-bit convolution is generated per kernel: zero taps vanish,
+// taps of +-1 become plain adds, and the sum of all taps over 0..255 fits in
+// a 16-bit lane (checked statically). Sums are packed back to 8 bits with
+// saturation, which is exactly what cv::filter2D's float path gives for
+// integer kernels, so results are bit-identical. Borders follow filter2D
+// too: pixels around an ROI come from the parent image, and the image's
+// edges are reflected (BORDER_REFLECT_101).
+//
+// The coefficient tables here are also what the presets load into the node.
+namespace PresetKernels {
+
+struct Sharpen3 {
+    static constexpr int size = 3;
+    static constexpr int k[9] = {  0, -1,  0,
+                                  -1,  5, -1,
+                                   0, -1,  0 };
+};
+
+struct Emboss3 {
+    static constexpr int size = 3;
+    static constexpr int k[9] = { -2, -1,  0,
+                                  -1,  1,  1,
+                                   0,  1,  2 };
+};
+
+struct EdgeEnhance3 {
+    static constexpr int size = 3;
+    static constexpr int k[9] = {  1,  1,  1,
+                                   1, -7,  1,
+                                   1,  1,  1 };
+};
+
+struct Sharpen5 {
+    static constexpr int size = 5;
+    static constexpr int k[25] = { -1, -1, -1, -1, -1,
+                                   -1,  2,  2,  2, -1,
+                                   -1,  2,  8,  2, -1,
+                                   -1,  2,  2,  2, -1,
+                                   -1, -1, -1, -1, -1 };
+};
+
+struct Emboss5 {
+    static constexpr int size = 5;
+    static constexpr int k[25] = { -2, -1,  0,  1,  2,
+                                   -2, -1,  0,  1,  2,
+                                   -2, -1,  0,  1,  2,
+                                   -2, -1,  0,  1,  2,
+                                   -2, -1,  0,  1,  2 };
+};
+
+struct EdgeEnhance5 {
+    static constexpr int size = 5;
+    static constexpr int k[25] = {  1,  1,   1,  1,  1,
+                                    1,  1,   1,  1,  1,
+                                    1,  1, -24,  1,  1,
+                                    1,  1,   1,  1,  1,
+                                    1,  1,   1,  1,  1 };
+};
+
+// Coefficients as the node stores them
+template <class K>
+std::vector<float> coefficients() {
+    return std::vector<float>(std::begin(K::k), std::end(K::k));
+}
+
+template <class K>
+bool matches(const std::vector<float>& kernel) {
+    return kernel == coefficients<K>();
+}
+
+// Largest magnitude the positive or the negative taps can add up to
+template <class K>
+constexpr int maxSum() {
+    int positive = 0, negative = 0;
+    for (int c : K::k)
+        (c > 0 ? positive : negative) += (c > 0 ? c : -c) * 255;
+    return positive > negative ? positive : negative;
+}
+
+// One output row: rows[y] points at source row y of the kernel's window,
+// padded by size / 2 pixels on both sides; n samples of cn channels each
+template <class K>
+void rowScalar(const uchar* const* rows, uchar* dst, int begin, int n, int cn) {
+    for (int i = begin; i < n; ++i) {
+        int sum = 0;
+        for (int y = 0; y < K::size; ++y)
+            for (int x = 0; x < K::size; ++x)
+                sum += K::k[y * K::size + x] * rows[y][i + x * cn];
+        dst[i] = cv::saturate_cast<uchar>(sum);
+    }
+}
+
+#ifdef PRESET_KERNELS_X86
+// acc + C * p[0..7], with the multiply folded away where C allows
+template <int C>
+PRESET_TARGET("sse4.1") inline __m128i tap(__m128i acc, const uchar* p) {
+    if constexpr (C == 0) {
+        return acc;
+    } else {
+        __m128i v = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+        if constexpr (C == 1)
+            return _mm_add_epi16(acc, v);
+        else if constexpr (C == -1)
+            return _mm_sub_epi16(acc, v);
+        else
+            return _mm_add_epi16(acc, _mm_mullo_epi16(v, _mm_set1_epi16(C)));
+    }
+}
+
+// acc + C * p[0..15]
+template <int C>
+PRESET_TARGET("avx2") inline __m256i tap(__m256i acc, const uchar* p) {
+    if constexpr (C == 0) {
+        return acc;
+    } else {
+        __m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        if constexpr (C == 1)
+            return _mm256_add_epi16(acc, v);
+        else if constexpr (C == -1)
+            return _mm256_sub_epi16(acc, v);
+        else
+            return _mm256_add_epi16(acc, _mm256_mullo_epi16(v, _mm256_set1_epi16(C)));
+    }
+}
+
+// All taps for the samples starting at i, unrolled at compile time
+template <class K, size_t... I>
+PRESET_TARGET("sse4.1") inline __m128i sumSSE41(const uchar* const* rows, int i, int cn, std::index_sequence<I...>) {
+    __m128i acc = _mm_setzero_si128();
+    ((acc = tap<K::k[I]>(acc, rows[I / K::size] + i + static_cast<int>(I % K::size) * cn)), ...);
+    return acc;
+}
+
+template <class K, size_t... I>
+PRESET_TARGET("avx2") inline __m256i sumAVX2(const uchar* const* rows, int i, int cn, std::index_sequence<I...>) {
+    __m256i acc = _mm256_setzero_si256();
+    ((acc = tap<K::k[I]>(acc, rows[I / K::size] + i + static_cast<int>(I % K::size) * cn)), ...);
+    return acc;
+}
+
+template <class K>
+PRESET_TARGET("sse4.1") void rowSSE41(const uchar* const* rows, uchar* dst, int begin, int n, int cn) {
+    constexpr auto taps = std::make_index_sequence<K::size * K::size>();
+    int i = begin;
+    for (; i + 16 <= n; i += 16) {
+        __m128i low = sumSSE41<K>(rows, i, cn, taps);
+        __m128i high = sumSSE41<K>(rows, i + 8, cn, taps);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+    }
+    rowScalar<K>(rows, dst, i, n, cn);
+}
+
+template <class K>
+PRESET_TARGET("avx2") void rowAVX2(const uchar* const* rows, uchar* dst, int begin, int n, int cn) {
+    constexpr auto taps = std::make_index_sequence<K::size * K::size>();
+    int i = begin;
+    for (; i + 32 <= n; i += 32) {
+        __m256i low = sumAVX2<K>(rows, i, cn, taps);
+        __m256i high = sumAVX2<K>(rows, i + 16, cn, taps);
+        // packus works per 128-bit lane; restore sample order afterwards
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    rowScalar<K>(rows, dst, i, n, cn);
+}
+#endif
+
+typedef void (*Row)(const uchar* const* rows, uchar* dst, int begin, int n, int cn);
+
+// Fastest row kernel the CPU supports
+template <class K>
+Row rowKernel() {
+#ifdef PRESET_KERNELS_X86
+    if (cv::checkHardwareSupport(cv::CPU_AVX2))
+        return rowAVX2<K>;
+    if (cv::checkHardwareSupport(cv::CPU_SSE4_1))
+        return rowSSE41<K>;
+#endif
+    return rowScalar<K>;
+}
+
+// Convolves an 8-bit image of any channel count into dst (same size and
+// type). Runs on the calling thread; callers split large images into bands.
+template <class K>
+void convolve(const cv::Mat& src, cv::Mat& dst) {
+    constexpr int n = K::size, halo = n / 2;
+    static_assert(maxSum<K>() <= 32767, "Sums must fit 16-bit lanes");
+    CV_Assert(src.depth() == CV_8U);
+    Row row = rowKernel<K>();
+    dst.create(src.size(), src.type());
+
+    // Whole parent image, whose pixels around src are read as filter2D does
+    cv::Size wholeSize;
+    cv::Point ofs;
+    src.locateROI(wholeSize, ofs);
+    cv::Mat whole = src;
+    whole.adjustROI(ofs.y, wholeSize.height - ofs.y - src.rows, ofs.x, wholeSize.width - ofs.x - src.cols);
+
+    int cn = src.channels(), samples = src.cols * cn;
+    size_t stride = static_cast<size_t>(src.cols + 2 * halo) * cn;
+    int first = std::max(-halo, -ofs.x), last = std::min(src.cols + halo, whole.cols - ofs.x);
+
+    // Padded copies of the n source rows around the output row; moving down
+    // one row refills only the slot of the row that left the window
+    std::vector<uchar> window(n * stride);
+    auto slot = [&](int y) { return window.data() + ((y % n + n) % n) * stride; };
+    auto fill = [&](int y) {
+        uchar* padded = slot(y);
+        const uchar* line = whole.ptr<uchar>(cv::borderInterpolate(ofs.y + y, whole.rows, cv::BORDER_REFLECT_101));
+        std::memcpy(padded + (first + halo) * cn, line + (ofs.x + first) * cn, (last - first) * cn);
+        for (int x = -halo; x < src.cols + halo; ++x) {
+            if (x == first)
+                x = last; // Inside the image, copied above
+            if (x >= src.cols + halo)
+                break;
+            int wx = cv::borderInterpolate(ofs.x + x, whole.cols, cv::BORDER_REFLECT_101);
+            std::memcpy(padded + (x + halo) * cn, line + wx * cn, cn);
+        }
+    };
+
+    const uchar* rows[n];
+    for (int y = -halo; y < halo; ++y)
+        fill(y);
+    for (int y = 0; y < src.rows; ++y) {
+        fill(y + halo);
+        for (int j = 0; j < n; ++j)
+            rows[j] = slot(y - halo + j);
+        row(rows, dst.ptr<uchar>(y), 0, samples, cn);
+    }
+}
+
+} // namespace PresetKernels
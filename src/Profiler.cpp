@@ -0,0 +1,121 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+uint32_t currentThreadId() {
+    static std::atomic<uint32_t> nextId{0};
+    thread_local uint32_t id = nextId++;
+    return id;
+}
+
+// Writes 's' as the body of a JSON string
+void appendEscaped(std::string& out, const char* s) {
+    for (; *s; ++s) {
+        unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+}
+
+} // namespace
+
+Profiler::Profiler() : slots(new Slot[kCapacity]) {}
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+uint64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::record(const char* name, const char* category, uint64_t startNs, uint64_t endNs) {
+    uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[index & (kCapacity - 1)];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Event& e = slot.event;
+    std::strncpy(e.name, name, sizeof(e.name) - 1);
+    e.name[sizeof(e.name) - 1] = '\0';
+    e.category = category;
+    e.startNs = startNs;
+    e.durationNs = endNs > startNs ? endNs - startNs : 0;
+    e.thread = currentThreadId();
+
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+std::vector<Profiler::Event> Profiler::snapshot(uint64_t sinceNs) const {
+    uint64_t end = head.load(std::memory_order_acquire);
+    uint64_t begin = std::max(end > kCapacity ? end - kCapacity : 0,
+                              clearedAt.load(std::memory_order_relaxed));
+
+    std::vector<Event> events;
+    events.reserve(end - std::min(begin, end));
+    for (uint64_t i = begin; i < end; ++i) {
+        const Slot& slot = slots[i & (kCapacity - 1)];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * i + 2)
+            continue; // Still being written, or already overwritten
+        Event e = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+            continue; // Overwritten while copying
+        if (e.startNs >= sinceNs)
+            events.push_back(e);
+    }
+    return events;
+}
+
+void Profiler::clear() {
+    clearedAt.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+bool Profiler::exportChromeTrace(const std::string& path) const {
+    std::vector<Event> events = snapshot();
+    uint64_t origin = UINT64_MAX;
+    for (const Event& e : events)
+        origin = std::min(origin, e.startNs);
+
+    std::string json = "{\"traceEvents\":[\n";
+    char numbers[128];
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Event& e = events[i];
+        json += "{\"name\":\"";
+        appendEscaped(json, e.name);
+        json += "\",\"cat\":\"";
+        appendEscaped(json, e.category);
+        // Timestamps are in microseconds
+        std::snprintf(numbers, sizeof(numbers), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                      (e.startNs - origin) / 1000.0, e.durationNs / 1000.0, e.thread);
+        json += numbers;
+        json += i + 1 < events.size() ? ",\n" : "\n";
+    }
+    json += "],\"displayTimeUnit\":\"ms\"}\n";
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(json.data(), json.size())) {
+        std::cerr << "Profiler: cannot write trace to " << path << std::endl;
+        return false;
+    }
+    std::cout << "Trace with " << events.size() << " events written to " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Collects timed events (node processing, input conversion, texture uploads,
+// UI frames, ...) from any thread, for the profiler panel and for export as
+// Chrome trace-event JSON (chrome://tracing, Perfetto).
+//
+// Events go into a fixed-size ring buffer without locks: a writer claims a
+// slot with one atomic increment and publishes it through the slot's sequence
+// number; readers copy slots and drop any that were rewritten meanwhile. When
+// the ring is full the oldest events are overwritten. Recording is off until
+// setEnabled(true); a disabled ProfileScope costs one relaxed load.
+class Profiler {
+public:
+    struct Event {
+        char name[48];        // Truncated copy, so callers may pass temporaries
+        const char* category; // Must be a string literal
+        uint64_t startNs;     // Profiler::now() at the start
+        uint64_t durationNs;
+        uint32_t thread;      // Small per-thread id, in order of first use
+    };
+
+    static Profiler& instance();
+
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Monotonic timestamp in nanoseconds
+    static uint64_t now();
+
+    void record(const char* name, const char* category, uint64_t startNs, uint64_t endNs);
+
+    // Events that started at or after sinceNs, in the order they finished
+    std::vector<Event> snapshot(uint64_t sinceNs = 0) const;
+
+    // Hides everything recorded so far from snapshot()
+    void clear();
+
+    // Writes the buffered events as a Chrome trace ("X" complete events)
+    bool exportChromeTrace(const std::string& path) const;
+
+private:
+    Profiler();
+
+    static constexpr uint64_t kCapacity = 1 << 14; // Power of two
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0}; // 2*index+1 while writing, 2*index+2 once written
+        Event event;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> head{0};      // Index of the next slot to write
+    std::atomic<uint64_t> clearedAt{0}; // Indices below this are hidden
+    std::atomic<bool> enabled{false};
+};
+
+// Records the time between construction and destruction as one event.
+// 'name' must stay valid for the scope's lifetime; 'category' must be a literal.
+class ProfileScope {
+public:
+    ProfileScope(const char* name, const char* category)
+        : name(name), category(category),
+          start(Profiler::instance().isEnabled() ? Profiler::now() : 0) {}
+
+    ~ProfileScope() {
+        if (start != 0)
+            Profiler::instance().record(name, category, start, Profiler::now());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    const char* category;
+    uint64_t start;
+};
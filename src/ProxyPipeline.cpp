@@ -0,0 +1,159 @@
+#include "ProxyPipeline.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+bool sameParams(const GraphDesc::Node& a, const GraphDesc::Node& b) {
+    if (a.params.size() != b.params.size())
+        return false;
+    for (size_t i = 0; i < a.params.size(); ++i) {
+        if (a.params[i].name != b.params[i].name || a.params[i].values != b.params[i].values)
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+ProxyPipeline::ProxyPipeline(Pipeline& source)
+    : source(source), proxy(Pipeline::create(source.describe())) {
+    if (!proxy)
+        std::cerr << "ProxyPipeline: failed to copy the pipeline" << std::endl;
+    else
+        proxy->getGraph().setThreadPool(source.getGraph().getThreadPool());
+}
+
+void ProxyPipeline::setCancelToken(const CancelToken* token) {
+    if (proxy)
+        proxy->getGraph().setCancelToken(token);
+}
+
+bool ProxyPipeline::update(int width) {
+    if (!proxy || width <= 0)
+        return false;
+    cv::Size size;
+    {
+        ImageInputNode* input = source.getInput();
+        std::lock_guard<std::mutex> lock(input->stateMutex);
+        size = input->getOutputImage().size();
+    }
+    if (size.width <= width)
+        return false;
+    return prepare(cv::Rect(cv::Point(), size), static_cast<double>(width) / size.width, false);
+}
+
+bool ProxyPipeline::updateRegion(const cv::Rect& wanted, double wantedScale) {
+    if (!proxy || wantedScale <= 0.0)
+        return false;
+    return prepare(wanted, std::min(wantedScale, 1.0), true);
+}
+
+bool ProxyPipeline::prepare(cv::Rect wanted, double wantedScale, bool crop) {
+    std::shared_ptr<ImagePyramid> pyramid;
+    uint64_t generation;
+    {
+        ImageInputNode* input = source.getInput();
+        std::lock_guard<std::mutex> lock(input->stateMutex);
+        if (input->getOutputImage().empty())
+            return false;
+        pyramid = input->getOutputPyramid();
+        generation = input->getOutputGeneration();
+    }
+    cv::Size size = pyramid->getSize();
+    cv::Rect image(cv::Point(), size);
+    wanted &= image;
+    if (wanted.empty())
+        return false;
+
+    if (wantedScale != scale) {
+        scale = wantedScale;
+        applied.clear(); // Scaled parameters depend on the scale
+    }
+    applySourceParams();
+
+    // Grow the crop to everything the output region depends on, so pixels
+    // inside 'wanted' see the same neighbours as in a full-frame render.
+    // Footprints are in proxy pixels, as the parameters have been scaled.
+    cv::Rect grown = image;
+    if (crop && wanted != image) {
+        cv::Rect scaled(cv::Point(static_cast<int>(std::floor(wanted.x * scale)),
+                                  static_cast<int>(std::floor(wanted.y * scale))),
+                        cv::Point(static_cast<int>(std::ceil(wanted.br().x * scale)),
+                                  static_cast<int>(std::ceil(wanted.br().y * scale))));
+        std::unordered_map<const NodeBase*, cv::Rect> regions;
+        if (!proxy->getGraph().propagateRegion(*proxy->getOutput(), scaled, regions) ||
+            !regions.count(proxy->getInput()))
+            return false;
+        cv::Rect needed = regions[proxy->getInput()];
+        grown = cv::Rect(cv::Point(static_cast<int>(std::floor(needed.x / scale)) - 1,
+                                   static_cast<int>(std::floor(needed.y / scale)) - 1),
+                         cv::Point(static_cast<int>(std::ceil(needed.br().x / scale)) + 1,
+                                   static_cast<int>(std::ceil(needed.br().y / scale)) + 1)) & image;
+    }
+
+    if (generation != inputGeneration || grown != inputRect || inputSize.width == 0) {
+        cv::Size target(std::max(1, static_cast<int>(std::lround(grown.width * scale))),
+                        std::max(1, static_cast<int>(std::lround(grown.height * scale))));
+        cv::Mat small;
+        if (target == grown.size()) {
+            // Full resolution: a view into the source image, nothing copied
+            small = pyramid->level(0)(grown);
+        } else {
+            // Area averaging from the nearest pyramid level, so the proxy
+            // matches what the preview's own downscale of a full-resolution
+            // frame would show. Building the levels here also keeps that work
+            // off the UI thread, which draws the input thumbnail from them.
+            cv::Mat base = pyramid->forWidth(static_cast<int>(std::ceil(size.width * scale)));
+            double f = static_cast<double>(base.cols) / size.width;
+            cv::Rect levelRect(cv::Point(static_cast<int>(grown.x * f), static_cast<int>(grown.y * f)),
+                               cv::Point(static_cast<int>(std::ceil(grown.br().x * f)),
+                                         static_cast<int>(std::ceil(grown.br().y * f))));
+            levelRect &= cv::Rect(0, 0, base.cols, base.rows);
+            cv::resize(base(levelRect), small, target, 0, 0, cv::INTER_AREA);
+        }
+        proxy->getInput()->setInputImage(small);
+
+        inputGeneration = generation;
+        inputRect = grown;
+        inputSize = small.size();
+    }
+    region = wanted;
+    return true;
+}
+
+void ProxyPipeline::applySourceParams() {
+    GraphDesc desc = source.describe();
+    const std::vector<std::unique_ptr<NodeBase>>& nodes = proxy->getNodes();
+    applied.resize(desc.nodes.size());
+    for (size_t i = 0; i < desc.nodes.size() && i < nodes.size(); ++i) {
+        // Untouched nodes keep their generation and their cached output
+        if (!applied[i].type.empty() && sameParams(applied[i], desc.nodes[i]))
+            continue;
+        Pipeline::applyParams(*nodes[i], desc.nodes[i]);
+        {
+            std::lock_guard<std::mutex> lock(nodes[i]->stateMutex);
+            nodes[i]->scaleParams(scale);
+        }
+        applied[i] = std::move(desc.nodes[i]);
+    }
+}
+
+const NodeGraph::Buffer& ProxyPipeline::evaluate() {
+    return proxy->getGraph().evaluate(*proxy->getOutput());
+}
+
+cv::Rect ProxyPipeline::getOutputRect(const cv::Mat& output) const {
+    if (output.size() != inputSize)
+        return cv::Rect();
+    double fx = static_cast<double>(inputSize.width) / inputRect.width;
+    double fy = static_cast<double>(inputSize.height) / inputRect.height;
+    cv::Point tl(static_cast<int>(std::lround((region.x - inputRect.x) * fx)),
+                 static_cast<int>(std::lround((region.y - inputRect.y) * fy)));
+    cv::Point br(static_cast<int>(std::lround((region.br().x - inputRect.x) * fx)),
+                 static_cast<int>(std::lround((region.br().y - inputRect.y) * fy)));
+    return cv::Rect(tl, br) & cv::Rect(cv::Point(), inputSize);
+}
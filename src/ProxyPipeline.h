@@ -0,0 +1,63 @@
+#pragma once
+#include "Pipeline.h"
+#include <opencv2/core.hpp>
+#include <memory>
+#include <vector>
+
+// Scaled or cropped copy of a pipeline for interactive previews.
+//
+// Holds a second Pipeline with the same nodes and connections whose input is
+// the source's input image downscaled (for a quick preview of the whole
+// image) or cropped to the part on screen (for a detail view), taken from the
+// input's pyramid and cached until the source image, the region or the scale
+// changes. Before each evaluation the source's parameters are copied over and
+// pixel-measured ones (blur radius, block sizes, ...) are scaled to match via
+// NodeBase::scaleParams(), so the proxy output approximates the corresponding
+// part of the full-resolution result for a fraction of the work.
+//
+// Only touched from the evaluation thread; reads the source nodes under
+// their stateMutex.
+class ProxyPipeline {
+public:
+    explicit ProxyPipeline(Pipeline& source);
+
+    // Whole input scaled to 'width' pixels wide. Returns false if a proxy is
+    // pointless: no input image, or the image is no wider than that already.
+    bool update(int width);
+
+    // 'region' of the input (full-resolution pixels) at 'scale' (at most 1).
+    // The crop covers everything the region depends on (see
+    // NodeGraph::propagateRegion). Returns false without an input image, or
+    // if some node needs its whole input (global statistics, output
+    // unrelated to the input).
+    bool updateRegion(const cv::Rect& region, double scale);
+
+    // Evaluates the proxy output; call after a successful update
+    const NodeGraph::Buffer& evaluate();
+
+    // Where the requested region lies in 'output' (from evaluate()), or an
+    // empty rect if the output doesn't have the input's geometry
+    cv::Rect getOutputRect(const cv::Mat& output) const;
+
+    // Requested region, in full-resolution pixels
+    cv::Rect getRegion() const { return region; }
+
+    // Proxy size over source size, e.g. 0.25
+    double getScale() const { return scale; }
+
+    // Makes evaluate() interruptible (see NodeGraph::setCancelToken)
+    void setCancelToken(const CancelToken* token);
+
+private:
+    bool prepare(cv::Rect wanted, double wantedScale, bool crop);
+    void applySourceParams();
+
+    Pipeline& source;
+    std::unique_ptr<Pipeline> proxy;
+    std::vector<GraphDesc::Node> applied; // Unscaled parameters last copied to each proxy node
+    uint64_t inputGeneration = 0;         // Source input the proxy image was made from
+    cv::Rect inputRect;                   // Part of the source input the proxy image shows
+    cv::Size inputSize;                   // Size of the proxy image
+    cv::Rect region;                      // Requested part of inputRect
+    double scale = 1.0;
+};
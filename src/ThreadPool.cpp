@@ -0,0 +1,96 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+namespace {
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local int currentIndex = -1;
+}
+
+ThreadPool::ThreadPool(size_t workerCount) {
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for (size_t i = 0; i < workerCount; ++i)
+        queues.push_back(std::make_unique<WorkQueue>());
+    for (size_t i = 0; i < workerCount; ++i)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread& t : workers)
+        t.join();
+}
+
+int ThreadPool::currentWorker() const {
+    return currentPool == this ? currentIndex : -1;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    // Workers keep follow-up tasks local; external callers spread them out
+    int self = currentWorker();
+    size_t index = self >= 0 ? static_cast<size_t>(self)
+                             : nextQueue.fetch_add(1) % queues.size();
+    {
+        // Counted before it becomes visible so a thief never drives it negative
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        ++pendingTasks;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    wakeUp.notify_one();
+}
+
+bool ThreadPool::popLocal(size_t index, std::function<void()>& task) {
+    WorkQueue& q = *queues[index];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty())
+        return false;
+    task = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(size_t thief, std::function<void()>& task) {
+    for (size_t i = 1; i < queues.size(); ++i) {
+        WorkQueue& q = *queues[(thief + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentIndex = static_cast<int>(index);
+
+    while (true) {
+        std::function<void()> task;
+        if (popLocal(index, task) || steal(index, task)) {
+            --pendingTasks;
+            try {
+                task();
+            } catch (const std::exception& e) {
+                std::cerr << "ThreadPool: task failed: " << e.what() << std::endl;
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this] { return stopping || pendingTasks > 0; });
+        if (stopping && pendingTasks == 0)
+            return;
+    }
+}
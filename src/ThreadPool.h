@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing task pool.
+//
+// Each worker owns a deque: it pushes and pops its own tasks at the back
+// (LIFO, cache friendly) and, when empty, steals from the front of the other
+// workers' deques. Tasks submitted from outside the pool are distributed
+// round-robin.
+class ThreadPool {
+public:
+    // workerCount == 0 uses one worker per hardware thread
+    explicit ThreadPool(size_t workerCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    size_t getWorkerCount() const { return queues.size(); }
+
+    // Index of the calling worker, or -1 if not called from this pool
+    int currentWorker() const;
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(size_t index);
+    bool popLocal(size_t index, std::function<void()>& task);
+    bool steal(size_t thief, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<size_t> pendingTasks{0};
+    std::atomic<size_t> nextQueue{0};
+    bool stopping = false;
+};
@@ -1,7 +1,7 @@
 #include "ThresholdNode.h"
-#include <imgui.h>
 #include <opencv2/imgproc.hpp>
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 
 ThresholdNode::ThresholdNode()
@@ -16,13 +16,12 @@ ThresholdNode::ThresholdNode()
 }
 
 void ThresholdNode::setInputImage(const cv::Mat& image) {
-    colorInput = image.clone();
+    colorInput = image;
     if (!image.empty() && image.channels() == 3) {
         cv::cvtColor(image, grayInput, cv::COLOR_BGR2GRAY);
     } else {
-        grayInput = image.clone();
+        grayInput = image; // Already gray: share
     }
-    dirty = true;
 }
 
 const cv::Mat& ThresholdNode::getOutputImage() const {
@@ -30,113 +29,157 @@ const cv::Mat& ThresholdNode::getOutputImage() const {
 }
 
 void ThresholdNode::process() {
-    if (!dirty) return;
     if (colorInput.empty()) {
         std::cerr << "ThresholdNode::process() - input is empty\n";
-        dirty = false;
         return;
     }
 
-    if (!useThreshold) {
-        outputImage = colorInput.clone();
+    // Snapshot parameters; the UI may edit them while we compute
+    bool enabled;
+    ThresholdMethod thresholdMethod;
+    int value, blockSize, c;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (adaptiveBlockSize % 2 == 0) adaptiveBlockSize++;  // Must be odd
+        if (adaptiveBlockSize < 3) adaptiveBlockSize = 3;
+        enabled = useThreshold;
+        thresholdMethod = method;
+        value = thresholdValue;
+        blockSize = adaptiveBlockSize;
+        c = adaptiveC;
+    }
+
+    // Counted once per input; parameter changes reuse it
+    std::shared_ptr<const Histogram> hist = inputHistogram();
+    if (!hist)
+        return;
+
+    cv::Mat result;
+    double otsuThresh = 0.0;
+    bool hasOtsu = false;
+    if (!enabled) {
+        result = colorInput;
     } else {
         if (grayInput.empty()) {
             std::cerr << "ThresholdNode::process() - grayscale is empty\n";
-            outputImage = colorInput.clone();
+            result = colorInput;
         } else {
-            switch (method) {
+            switch (thresholdMethod) {
                 case ThresholdMethod::Binary:
-                    cv::threshold(grayInput, outputImage, thresholdValue, 255, cv::THRESH_BINARY);
+                    cv::threshold(grayInput, result, value, 255, cv::THRESH_BINARY);
                     break;
                 case ThresholdMethod::Otsu:
-                    computedOtsuThresh = cv::threshold(grayInput, outputImage, 0, 255,
-                                                       cv::THRESH_BINARY | cv::THRESH_OTSU);
+                    // Same threshold THRESH_OTSU finds, without its own pass
+                    otsuThresh = hist->otsuThreshold();
+                    cv::threshold(grayInput, result, otsuThresh, 255, cv::THRESH_BINARY);
+                    hasOtsu = true;
                     break;
-                case ThresholdMethod::Adaptive:
-                    if (adaptiveBlockSize % 2 == 0) adaptiveBlockSize++;  // Must be odd
-                    if (adaptiveBlockSize < 3) adaptiveBlockSize = 3;
-                    cv::adaptiveThreshold(grayInput, outputImage, 255,
-                                          cv::ADAPTIVE_THRESH_GAUSSIAN_C,
-                                          cv::THRESH_BINARY,
-                                          adaptiveBlockSize, adaptiveC);
+                case ThresholdMethod::Adaptive: {
+                    // Bands of rows, each grown by half a block so its own
+                    // border handling never reaches the rows it keeps; lets
+                    // a superseded evaluation stop early.
+                    int halo = blockSize / 2;
+                    result.create(grayInput.size(), CV_8UC1);
+                    bool finished = forEachBand(grayInput.rows, 64, [&](const cv::Range& rows) {
+                        int begin = std::max(0, rows.start - halo);
+                        int end = std::min(grayInput.rows, rows.end + halo);
+                        cv::Mat band;
+                        cv::adaptiveThreshold(grayInput.rowRange(begin, end), band, 255,
+                                              cv::ADAPTIVE_THRESH_GAUSSIAN_C,
+                                              cv::THRESH_BINARY,
+                                              blockSize, c);
+                        cv::Mat dst = result.rowRange(rows);
+                        band.rowRange(rows.start - begin, rows.end - begin).copyTo(dst);
+                    });
+                    if (!finished)
+                        return;
                     break;
+                }
             }
         }
     }
 
-    // Histogram generation - now based on output image if thresholding is applied
-    {
-        cv::Mat histSource;
-
-        if (useThreshold && !outputImage.empty()) {
-            histSource = outputImage.clone();
-        } else if (!grayInput.empty()) {
-            histSource = grayInput.clone();
-        } else {
-            histSource = colorInput.clone();
-        }
-
-        if (!histSource.empty() && histSource.channels() == 3) {
-            cv::cvtColor(histSource, histSource, cv::COLOR_BGR2GRAY);
-        }
-
-        int histSize = 256;
-        float range[] = { 0, 256 };
-        const float* histRange = { range };
-        cv::Mat hist;
-        cv::calcHist(&histSource, 1, 0, cv::Mat(), hist, 1, &histSize, &histRange);
-
-        histogramData.resize(histSize);
-        for (int i = 0; i < histSize; ++i) {
-            histogramData[i] = hist.at<float>(i);
-        }
-    }
-
-    dirty = false;
+    std::lock_guard<std::mutex> lock(stateMutex);
+    outputImage = result;
+    histogram = hist;
+    histogramGeneration = inputGeneration;
+    if (hasOtsu)
+        computedOtsuThresh = otsuThresh;
 }
 
+std::shared_ptr<const Histogram> ThresholdNode::inputHistogram() {
+    if (histogram && histogramGeneration == inputGeneration)
+        return histogram;
+    return Histogram::compute(colorInput, colorInput.channels() > 1 ? grayInput : cv::Mat(), cancelToken);
+}
 
-void ThresholdNode::drawUI() {
-    
-    ImGui::Text("Threshold Node");
-    bool changed = false;
-
-    changed |= ImGui::Checkbox("Enable Thresholding", &useThreshold);
-
-    const char* methods[] = { "Binary", "Otsu", "Adaptive" };
-    int methodIdx = static_cast<int>(method);
-    if (ImGui::Combo("Method", &methodIdx, methods, IM_ARRAYSIZE(methods))) {
-        method = static_cast<ThresholdMethod>(methodIdx);
-        changed = true;
-    }
-
-    if (method == ThresholdMethod::Binary) {
-        changed |= ImGui::SliderInt("Threshold Value", &thresholdValue, 0, 255);
-    } else if (method == ThresholdMethod::Otsu) {
-        ImGui::Text("Otsu determines threshold automatically.");
-        if (!grayInput.empty()) {
-            ImGui::Text("Computed Threshold: %.2f", computedOtsuThresh);
-        }
-    } else if (method == ThresholdMethod::Adaptive) {
-        changed |= ImGui::SliderInt("Block Size (odd)", &adaptiveBlockSize, 3, 31);
-        changed |= ImGui::SliderInt("C Value", &adaptiveC, -20, 20);
-    }
+void ThresholdNode::scaleParams(double factor) {
+    // Adaptive block sizes must stay odd and at least 3
+    adaptiveBlockSize = std::max(3, static_cast<int>(std::lround(adaptiveBlockSize * factor))) | 1;
+}
 
-    if (changed) {
-        dirty = true ;
-        process();
+bool ThresholdNode::getTileKernel(TileKernel& kernel) const {
+    // Otsu picks its threshold from the whole image's histogram
+    if (method == ThresholdMethod::Otsu)
+        return false;
+
+    ThresholdMethod thresholdMethod = method;
+    int value = thresholdValue, c = adaptiveC;
+    int blockSize = std::max(3, adaptiveBlockSize | 1); // Same clamp as process()
+
+    kernel.halo = thresholdMethod == ThresholdMethod::Adaptive ? blockSize / 2 : 0;
+    kernel.outputChannels = 1;
+    kernel.apply = [thresholdMethod, value, blockSize, c](const cv::Mat& src, const cv::Rect&, cv::Mat& dst) {
+        cv::Mat gray;
+        if (src.channels() == 3)
+            cv::cvtColor(src, gray, cv::COLOR_BGR2GRAY);
+        else
+            gray = src;
+
+        if (thresholdMethod == ThresholdMethod::Adaptive)
+            cv::adaptiveThreshold(gray, dst, 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C,
+                                  cv::THRESH_BINARY, blockSize, c);
+        else
+            cv::threshold(gray, dst, value, 255, cv::THRESH_BINARY);
     };
+    return true;
+}
 
-    
-    if (!histogramData.empty()) {
-        ImGui::Text("Histogram:");
-        float maxVal = *std::max_element(histogramData.begin(), histogramData.end());
-        ImGui::PlotHistogram("##histogram", histogramData.data(),
-                             static_cast<int>(histogramData.size()), 0,
-                             nullptr, 0.0f, maxVal, ImVec2(0, 80));
-    }
+bool ThresholdNode::getPointOps(std::vector<PointOp>& ops) const {
+    if (method != ThresholdMethod::Binary)
+        return false;
+
+    PointOp gray;
+    gray.kind = PointOp::Gray; // No-op on gray input, as in setInputImage()
+    PointOp binary;
+    binary.channels = 1;
+    binary.tables.resize(1);
+    for (int v = 0; v < 256; ++v)
+        binary.tables[0][v] = v > thresholdValue ? 255 : 0; // THRESH_BINARY
+    ops.push_back(gray);
+    ops.push_back(binary);
+    return true;
+}
+
+void ThresholdNode::setTiledOutput(const cv::Mat& image, bool inputHeld) {
+    // Further down a chain the input only ever existed tile by tile
+    std::shared_ptr<const Histogram> hist;
+    if (inputHeld)
+        hist = inputHistogram();
+    NodeBase::setTiledOutput(image, inputHeld);
+    std::lock_guard<std::mutex> lock(stateMutex);
+    histogram = hist;
+    histogramGeneration = hist ? inputGeneration : 0;
+}
 
-    if (ImGui::Button("Reset")) {
-        reset();
+bool ThresholdNode::getInputRegion(int, const cv::Rect& outputRegion, cv::Rect& inputRegion) const {
+    if (!useThreshold || method == ThresholdMethod::Binary) {
+        inputRegion = outputRegion;
+        return true;
     }
+    if (method == ThresholdMethod::Otsu)
+        return false; // Threshold depends on every pixel
+    int reach = std::max(3, adaptiveBlockSize | 1) / 2;
+    inputRegion = growRegion(outputRegion, reach, reach);
+    return true;
 }
@@ -1,6 +1,8 @@
 #pragma once
+#include "Histogram.h"
 #include "NodeBase.h"
 #include <opencv2/opencv.hpp>
+#include <memory>
 #include <vector>
 
 enum class ThresholdMethod {
@@ -16,7 +18,33 @@ class ThresholdNode : public NodeBase {
         void setInputImage(const cv::Mat& image) ;
         const cv::Mat& getOutputImage() const ;
         void process() override;
-        void drawUI() override;
+        const char* getTypeName() const override { return "Threshold"; }
+        void visitParams(ParamVisitor& v) override {
+            v.visit("enabled", useThreshold);
+            v.visit("method", method);
+            v.visit("threshold", thresholdValue);
+            v.visit("blockSize", adaptiveBlockSize);
+            v.visit("c", adaptiveC);
+            clampParam(method, ThresholdMethod::Binary, ThresholdMethod::Adaptive);
+            clampParam(thresholdValue, 0, 255);
+            clampParam(adaptiveBlockSize, 3, 255);
+            adaptiveBlockSize |= 1;
+            clampParam(adaptiveC, -255, 255);
+        }
+        void scaleParams(double factor) override;
+        friend class NodePanels; // Property panel, drawn by the GUI
+        bool isPassThrough() const override { return !useThreshold; }
+        bool getTileKernel(TileKernel& kernel) const override;
+        bool getPointOps(std::vector<PointOp>& ops) const override;
+        bool getInputRegion(int port, const cv::Rect& outputRegion, cv::Rect& inputRegion) const override;
+        void setTiledOutput(const cv::Mat& image, bool inputHeld) override;
+
+        // Histogram of the input image (per channel, plus luminance), for
+        // downstream consumers; null before the first run
+        std::shared_ptr<const Histogram> getHistogram() const {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            return histogram;
+        }
         void reset() override {
             NodeBase::reset(); // Call base class reset
             useThreshold = false;
@@ -24,10 +52,13 @@ class ThresholdNode : public NodeBase {
             adaptiveBlockSize = 11;
             adaptiveC = 2;
             computedOtsuThresh = 0.0;
-            dirty= true; // Mark as dirty
         }
     
     private:
+        // Histogram of the current input, reused until the input generation
+        // changes. Evaluation thread only; null if cancelled.
+        std::shared_ptr<const Histogram> inputHistogram();
+
         bool useThreshold;
         int thresholdValue;
         ThresholdMethod method;
@@ -39,6 +70,11 @@ class ThresholdNode : public NodeBase {
         // Otsu threshold result
         double computedOtsuThresh;
     
-        cv::Mat colorInput, grayInput, outputImage;
-        std::vector<float> histogramData; // Histogram data for UI display
+        cv::Mat colorInput, grayInput;
+
+        // Published with the output, under stateMutex; written only by the
+        // evaluation thread, which may read it without the lock
+        std::shared_ptr<const Histogram> histogram;
+        uint64_t histogramGeneration = 0; // inputGeneration it was computed from
+        int histogramView = 0;            // Panel only: 0 = luminance, else channel + 1
 };
\ No newline at end of file
@@ -0,0 +1,394 @@
+#include "NodePanels.h"
+#include "BrightnessContrastNode.h"
+#include "ColorChannelSplitterNode.h"
+#include "BlurNode.h"
+#include "BlendNode.h"
+#include "ThresholdNode.h"
+#include "NoiseGenerationNode.h"
+#include "EdgeDetectionNode.h"
+#include "ConvolutionFilterNode.h"
+#include "ImageInputNode.h"
+#include "OutputNode.h"
+#include "OpenGLHelper.h"
+#include <imgui.h>
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <string>
+
+void NodePanels::draw(NodeBase& node) {
+    if (auto* n = dynamic_cast<BrightnessContrastNode*>(&node)) drawBrightnessContrast(*n);
+    else if (auto* n = dynamic_cast<ColorChannelSplitterNode*>(&node)) drawChannelSplitter(*n);
+    else if (auto* n = dynamic_cast<BlurNode*>(&node)) drawBlur(*n);
+    else if (auto* n = dynamic_cast<BlendNode*>(&node)) drawBlend(*n);
+    else if (auto* n = dynamic_cast<ThresholdNode*>(&node)) drawThreshold(*n);
+    else if (auto* n = dynamic_cast<NoiseGenerationNode*>(&node)) drawNoise(*n);
+    else if (auto* n = dynamic_cast<EdgeDetectionNode*>(&node)) drawEdgeDetection(*n);
+    else if (auto* n = dynamic_cast<ConvolutionFilterNode*>(&node)) drawConvolution(*n);
+    else if (auto* n = dynamic_cast<ImageInputNode*>(&node)) drawImageInput(*n);
+    else if (auto* n = dynamic_cast<OutputNode*>(&node)) drawOutput(*n);
+    else ImGui::Text("%s", node.getNodeName().c_str());
+}
+
+void NodePanels::release() {
+    if (inputTexture != 0) {
+        glDeleteTextures(1, &inputTexture);
+        inputTexture = 0;
+    }
+    inputTextureGeneration = 0;
+    inputTextureWidth = 0;
+}
+
+void NodePanels::drawBrightnessContrast(BrightnessContrastNode& node) {
+    ImGui::Text("Brightness/Contrast Node");
+    bool changed = false;
+    changed |= ImGui::SliderFloat("Brightness", &node.brightness, -100.0f, 100.0f);
+    changed |= ImGui::SliderFloat("Contrast", &node.contrast, 0.0f, 3.0f);
+
+    if (changed) {
+        node.markParametersChanged();  // Mark dirty if user changes sliders
+    }
+    if (ImGui::Button("Reset")) {
+        node.reset(); // Call the reset method
+    }
+}
+
+void NodePanels::drawChannelSplitter(ColorChannelSplitterNode& node) {
+    ImGui::Text("Color Channel Splitter Node");
+    bool updated = false;
+    updated |= ImGui::Checkbox("Show Red Channel", &node.showRed);
+    updated |= ImGui::Checkbox("Show Green Channel", &node.showGreen);
+    updated |= ImGui::Checkbox("Show Blue Channel", &node.showBlue);
+
+    if (updated) {
+        node.markParametersChanged();
+    }
+
+    if (node.outputImage.empty()) {
+        ImGui::Text("No output image available.");
+    } else {
+        ImGui::Text("Output image is ready.");
+    }
+    if (ImGui::Button("Reset")) {
+        node.reset(); // Call the reset method
+    }
+}
+
+void NodePanels::drawBlur(BlurNode& node) {
+    ImGui::Text("Blur Node");
+
+    bool changed = false;
+
+    changed |= ImGui::Checkbox("Use Blur Node", &node.useBlurNode);
+    changed |= ImGui::SliderInt("Blur Radius", &node.blurRadius, 1, BlurNode::kMaxRadius, "%d",
+                                ImGuiSliderFlags_Logarithmic);
+    changed |= ImGui::Checkbox("Uniform Blur (2D)", &node.uniformBlur);
+
+    if (!node.uniformBlur)
+        changed |= ImGui::Checkbox("Horizontal Blur", &node.directionHorizontal);
+
+    const char* engines[] = { "Auto", "Kernel", "Recursive", "Box" };
+    int engineIdx = static_cast<int>(node.engine);
+    if (ImGui::Combo("Engine", &engineIdx, engines, IM_ARRAYSIZE(engines))) {
+        node.engine = static_cast<BlurEngine>(engineIdx);
+        changed = true;
+    }
+    LargeBlur::Method method;
+    if (BlurNode::usesLargeBlur(node.engine, node.blurRadius, method))
+        ImGui::Text("Constant-time %s blur", method == LargeBlur::Method::Box ? "box" : "recursive");
+    else
+        ImGui::Text("Gaussian kernel, %d taps", 2 * node.blurRadius + 1);
+
+    if (changed) node.markParametersChanged();
+
+    if (!node.kernelPreview.empty() && node.useBlurNode) {
+        ImGui::Text("Kernel Preview:");
+        // Row or column vector; continuous either way
+        ImGui::PlotLines("##kernel", node.kernelPreview.ptr<float>(), static_cast<int>(node.kernelPreview.total()),
+                         0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 60));
+    }
+
+    ImGui::Text("%s", node.getOutputImage().empty() ? "No output image." : "Output image ready.");
+    if (ImGui::Button("Reset")) {
+        node.reset(); // Call the reset method
+    }
+}
+
+void NodePanels::drawBlend(BlendNode& node) {
+    ImGui::Text("Blend Node");
+
+    bool changed = false;
+
+    // Checkbox for enabling blending
+    changed |= ImGui::Checkbox("Enable Blending", &node.useBlend);
+
+    const char* modes[] = { "Normal", "Multiply", "Screen", "Overlay", "Difference" };
+    int currentMode = static_cast<int>(node.blendMode);
+    if (ImGui::Combo("Blend Mode", &currentMode, modes, IM_ARRAYSIZE(modes))) {
+        node.blendMode = static_cast<BlendMode>(currentMode);
+        changed = true;
+    }
+
+    if (ImGui::SliderFloat("Opacity", &node.opacity, 0.0f, 1.0f)) {
+        changed = true;
+    }
+
+    if (changed) {
+        node.markParametersChanged();
+    }
+
+    if (!node.outputImage.empty()) {
+        ImGui::Text("Output image ready.");
+    } else {
+        ImGui::Text("No output image.");
+    }
+    if (ImGui::Button("Reset")) {
+        node.reset(); // Call the reset method
+    }
+}
+
+void NodePanels::drawThreshold(ThresholdNode& node) {
+    ImGui::Text("Threshold Node");
+    bool changed = false;
+
+    changed |= ImGui::Checkbox("Enable Thresholding", &node.useThreshold);
+
+    const char* methods[] = { "Binary", "Otsu", "Adaptive" };
+    int methodIdx = static_cast<int>(node.method);
+    if (ImGui::Combo("Method", &methodIdx, methods, IM_ARRAYSIZE(methods))) {
+        node.method = static_cast<ThresholdMethod>(methodIdx);
+        changed = true;
+    }
+
+    if (node.method == ThresholdMethod::Binary) {
+        changed |= ImGui::SliderInt("Threshold Value", &node.thresholdValue, 0, 255);
+    } else if (node.method == ThresholdMethod::Otsu) {
+        ImGui::Text("Otsu determines threshold automatically.");
+        if (!node.outputImage.empty()) {
+            ImGui::Text("Computed Threshold: %.2f", node.computedOtsuThresh);
+        }
+    } else if (node.method == ThresholdMethod::Adaptive) {
+        changed |= ImGui::SliderInt("Block Size (odd)", &node.adaptiveBlockSize, 3, 31);
+        changed |= ImGui::SliderInt("C Value", &node.adaptiveC, -20, 20);
+    }
+
+    if (changed) {
+        node.markParametersChanged();
+    }
+
+    // Input histogram: counted once per input, so moving the threshold
+    // only moves the marker
+    if (std::shared_ptr<const Histogram> histogram = node.histogram) {
+        int channels = std::min(histogram->getChannels(), 4);
+        if (channels > 1) {
+            const char* views[] = { "Luminance", "Blue", "Green", "Red", "Alpha" };
+            ImGui::Combo("Histogram", &node.histogramView, views, channels + 1);
+        }
+        node.histogramView = std::min(node.histogramView, channels > 1 ? channels : 0);
+        const Histogram::Bins& bins = node.histogramView == 0 ? histogram->getLuminance()
+                                                              : histogram->getChannel(node.histogramView - 1);
+        std::vector<float> values(bins.begin(), bins.end());
+        float maxVal = *std::max_element(values.begin(), values.end());
+
+        char marker[32] = "";
+        if (node.method == ThresholdMethod::Binary)
+            std::snprintf(marker, sizeof(marker), "threshold %d", node.thresholdValue);
+        else if (node.method == ThresholdMethod::Otsu)
+            std::snprintf(marker, sizeof(marker), "Otsu %.0f", node.computedOtsuThresh);
+
+        ImGui::Text("Input Histogram:");
+        ImGui::PlotHistogram("##histogram", values.data(),
+                             static_cast<int>(values.size()), 0,
+                             marker, 0.0f, maxVal, ImVec2(0, 80));
+    } else if (node.useThreshold && !node.outputImage.empty()) {
+        ImGui::Text("Histogram unavailable: input only exists tile by tile.");
+    }
+
+    if (ImGui::Button("Reset")) {
+        node.reset();
+    }
+}
+
+void NodePanels::drawNoise(NoiseGenerationNode& node) {
+    ImGui::Text("Noise Generation Node");
+    bool changed = false;
+
+    // Checkbox to enable or disable noise generation
+    changed |= ImGui::Checkbox("Enable Noise", &node.useNoise);
+
+    // Noise type selection
+    const char* types[] = { "Perlin", "Simplex", "Worley" };
+    int noiseIdx = static_cast<int>(node.noiseType);
+    if (ImGui::Combo("Noise Type", &noiseIdx, types, IM_ARRAYSIZE(types))) {
+        node.noiseType = static_cast<NoiseType>(noiseIdx);
+        changed = true;
+    }
+
+    // Output mode
+    const char* modes[] = { "Color Output", "Displacement Map" };
+    int outputIdx = static_cast<int>(node.outputMode);
+    if (ImGui::Combo("Output Mode", &outputIdx, modes, IM_ARRAYSIZE(modes))) {
+        node.outputMode = static_cast<NoiseOutputMode>(outputIdx);
+        changed = true;
+    }
+
+    changed |= ImGui::SliderFloat("Scale", &node.scale, 0.001f, 0.1f);
+    changed |= ImGui::SliderInt("Octaves", &node.octaves, 1, 8);
+    changed |= ImGui::SliderFloat("Persistence", &node.persistence, 0.1f, 1.0f);
+
+    if (changed) {
+        node.markParametersChanged();
+    }
+    if (ImGui::Button("Reset")) {
+        node.reset(); // Call the reset method
+    }
+}
+
+void NodePanels::drawEdgeDetection(EdgeDetectionNode& node) {
+    ImGui::Text("Edge Detection Node");
+    bool changed = false;
+
+    const char* methods[] = { "Sobel", "Canny" };
+    int methodIdx = static_cast<int>(node.method);
+    if (ImGui::Combo("Method", &methodIdx, methods, IM_ARRAYSIZE(methods))) {
+        node.method = static_cast<EdgeMethod>(methodIdx);
+        changed = true;
+    }
+
+    if (node.method == EdgeMethod::Sobel) {
+        changed |= ImGui::SliderInt("Sobel Kernel Size", &node.sobelKernelSize, 1, 7);
+        if (node.sobelKernelSize % 2 == 0) node.sobelKernelSize += 1; // Ensure it's odd
+    } else if (node.method == EdgeMethod::Canny) {
+        changed |= ImGui::SliderInt("Canny Threshold 1", &node.cannyThreshold1, 0, 255);
+        changed |= ImGui::SliderInt("Canny Threshold 2", &node.cannyThreshold2, 0, 255);
+    }
+
+    changed |= ImGui::Checkbox("Overlay on Original", &node.overlayEdges);
+
+    if (changed) {
+        node.markParametersChanged();
+    }
+    if (ImGui::Button("Reset")) {
+        node.reset(); // Call the reset method
+    }
+}
+
+void NodePanels::drawConvolution(ConvolutionFilterNode& node) {
+    ImGui::Text("Convolution Filter Node");
+    bool changed = false;
+
+    // Checkbox for enabling/disabling filter (if disabled, original image shows)
+    changed |= ImGui::Checkbox("Enable Filter", &node.useFilter);
+
+    // Kernel size, odd only
+    int size = node.kernelSize;
+    if (ImGui::SliderInt("Kernel Size", &size, 1, ConvolutionFilterNode::kMaxKernelSize) &&
+        (size | 1) != node.kernelSize) {
+        node.kernelSize = size | 1;
+        node.updateKernelPreset();
+        changed = true;
+    }
+
+    // Kernel preset selection combo
+    const char* presets[] = { "Custom", "Sharpen", "Emboss", "Edge Enhance" };
+    int presetIdx = static_cast<int>(node.kernelPreset);
+    if (ImGui::Combo("Preset", &presetIdx, presets, IM_ARRAYSIZE(presets))) {
+        node.kernelPreset = static_cast<KernelPreset>(presetIdx);
+        node.updateKernelPreset();
+        changed = true;
+    }
+
+    // Allow manual editing only in Custom preset mode, and only for kernels
+    // small enough to fit the panel
+    if (node.kernelPreset == KernelPreset::Custom && node.kernelSize > 9) {
+        ImGui::Text("Kernels above 9x9 are edited in the saved graph file.");
+    } else if (node.kernelPreset == KernelPreset::Custom) {
+        int totalElements = node.kernelSize * node.kernelSize;
+        for (int i = 0; i < totalElements; ++i) {
+            std::string label = "K" + std::to_string(i);
+            changed |= ImGui::InputFloat(label.c_str(), &node.customKernel[i], 0.1f, 1.0f, "%.2f");
+            if ((i + 1) % node.kernelSize != 0)
+                ImGui::SameLine();
+        }
+    } else {
+        ImGui::Text("Switch to 'Custom' preset to edit kernel values manually.");
+    }
+
+    if (changed) {
+        node.markParametersChanged();
+    }
+
+    // How the last run executed the kernel (see ConvolutionPlan)
+    if (node.plan && node.useFilter) {
+        const ConvolutionPlan& plan = *node.plan;
+        const char* label = "Strategy";
+        if (plan.hasIntegerKernel()) {
+            ImGui::Text("Strategy: specialized integer kernel for 8-bit images");
+            label = "Other depths";
+        }
+        if (plan.getStrategy() == ConvolutionPlan::LowRank)
+            ImGui::Text("%s: %s, %d separable terms", label, plan.getStrategyName(), plan.getRank());
+        else if (plan.getStrategy() == ConvolutionPlan::Fft)
+            ImGui::Text("%s: %s, %dx%d blocks", label, plan.getStrategyName(), plan.getBlockSize(), plan.getBlockSize());
+        else
+            ImGui::Text("%s: %s", label, plan.getStrategyName());
+        ImGui::Text("Estimated cost: %.0f multiply-adds per pixel", plan.getEstimatedCost());
+        if (plan.getError() > 0.0)
+            ImGui::Text("Approximation error: %.5f", plan.getError());
+        if (plan.getMeasuredNsPerPixel() > 0.0)
+            ImGui::Text("Measured: %.2f ns per pixel", plan.getMeasuredNsPerPixel());
+    }
+
+    if (!node.outputImage.empty()) {
+        ImGui::Text("Kernel Effect Preview:");
+    }
+    if (ImGui::Button("Reset")) {
+        node.reset(); // Call the reset method
+    }
+}
+
+void NodePanels::drawImageInput(ImageInputNode& node) {
+    ImGui::Text("Image Input Node");
+
+    if (!node.inputImage.empty()) {
+        ImGui::Text("Image loaded successfully.");
+
+        // Thumbnail from the input's pyramid: the smallest level already
+        // built (by the evaluation thread) that covers it
+        float maxWidth = 200.0f; // Optional: scale to fit UI
+        cv::Mat thumbnail = node.getOutputPyramid()->forWidth(static_cast<int>(maxWidth), false);
+
+        // Regenerate texture if a newer image was loaded, or a smaller level
+        // became available, since the last upload
+        if (inputTextureGeneration != node.outputGeneration || inputTextureWidth != thumbnail.cols) {
+            release(); // Delete old texture
+            ProfileScope scope("Input texture upload", "texture");
+            OpenGLHelper::cvMatToTexture(thumbnail, inputTexture); // Generate new texture
+            inputTextureGeneration = node.outputGeneration;
+            inputTextureWidth = thumbnail.cols;
+        }
+
+        if (inputTexture != 0) {
+            ImTextureID texID = (ImTextureID)(uintptr_t)inputTexture;
+            float scale = std::min(maxWidth / node.inputImage.cols, 1.0f);
+            ImVec2 imageSize(node.inputImage.cols * scale, node.inputImage.rows * scale);
+            ImGui::Image(texID, imageSize);
+        }
+    } else {
+        ImGui::Text("No image loaded.");
+        release();
+    }
+}
+
+void NodePanels::drawOutput(OutputNode& node) {
+    ImGui::Text("Output Node");
+
+    if (ImGui::Button("Save Output"))
+        saveRequested = true; // Runs once the lock is released
+
+    if (!node.outputImage.empty()) {
+        ImGui::Text("Output image available.");
+    } else {
+        ImGui::Text("No output image available.");
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "NodeBase.h"
+#include <GL/glew.h>
+#include <cstdint>
+
+class BrightnessContrastNode;
+class ColorChannelSplitterNode;
+class BlurNode;
+class BlendNode;
+class ThresholdNode;
+class NoiseGenerationNode;
+class EdgeDetectionNode;
+class ConvolutionFilterNode;
+class ImageInputNode;
+class OutputNode;
+
+// ImGui property panels for the node types.
+//
+// The nodes themselves know nothing about the UI; this is the GUI's view of
+// them. draw() must be called with the node's stateMutex held (see NodeBase)
+// and edits parameters in place, calling markParametersChanged() on change.
+class NodePanels {
+public:
+    void draw(NodeBase& node);
+
+    // Frees GL resources; call before the GL context goes away
+    void release();
+
+    // True once after the Output panel's Save button was pressed. The save
+    // itself waits for the whole output and encodes, so the caller runs it
+    // after releasing the node's lock.
+    bool takeSaveRequest() {
+        bool requested = saveRequested;
+        saveRequested = false;
+        return requested;
+    }
+
+private:
+    static void drawBrightnessContrast(BrightnessContrastNode& node);
+    static void drawChannelSplitter(ColorChannelSplitterNode& node);
+    static void drawBlur(BlurNode& node);
+    static void drawBlend(BlendNode& node);
+    static void drawThreshold(ThresholdNode& node);
+    static void drawNoise(NoiseGenerationNode& node);
+    static void drawEdgeDetection(EdgeDetectionNode& node);
+    static void drawConvolution(ConvolutionFilterNode& node);
+    void drawOutput(OutputNode& node);
+    void drawImageInput(ImageInputNode& node);
+
+    GLuint inputTexture = 0;
+    uint64_t inputTextureGeneration = 0; // Output generation uploaded to inputTexture
+    int inputTextureWidth = 0;           // Width of the pyramid level uploaded
+    bool saveRequested = false;          // See takeSaveRequest()
+};
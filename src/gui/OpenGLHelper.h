@@ -0,0 +1,263 @@
+// filepath: c:\Users\jatin\node-image-processor\src\OpenGLHelper.h
+#pragma once
+#include <GL/glew.h>
+#include <opencv2/opencv.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/highgui.hpp>
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace OpenGLHelper {
+
+// Bilinear resize of an 8-bit gray/BGR/BGRA image straight into an RGBA
+// buffer, swapping channels and filling alpha in the same pass. Replaces the
+// cv::resize + cv::cvtColor pair (two passes and a temporary) on the preview
+// path. dst is reused when it already has the right size.
+//
+// Sampling matches cv::resize INTER_LINEAR (pixel-center aligned) using 11-bit
+// fixed-point weights. Column offsets and weights are precomputed once so the
+// inner loop is branch free; large outputs are split across cores.
+inline void resizeToRGBA(const cv::Mat& src, cv::Size dstSize, cv::Mat& dst) {
+    const int cn = src.channels();
+    if (src.empty() || dstSize.width <= 0 || dstSize.height <= 0)
+        return;
+    if (src.depth() != CV_8U || (cn != 1 && cn != 3 && cn != 4)) {
+        // Uncommon formats take the generic route
+        cv::Mat tmp;
+        src.convertTo(tmp, CV_8U);
+        cv::resize(tmp, tmp, dstSize);
+        int code = tmp.channels() == 1 ? cv::COLOR_GRAY2RGBA
+                 : tmp.channels() == 4 ? cv::COLOR_BGRA2RGBA : cv::COLOR_BGR2RGBA;
+        cv::cvtColor(tmp, dst, code);
+        return;
+    }
+
+    dst.create(dstSize, CV_8UC4);
+
+    const int kShift = 11;
+    const int kOne = 1 << kShift;
+    const double scaleX = static_cast<double>(src.cols) / dstSize.width;
+    const double scaleY = static_cast<double>(src.rows) / dstSize.height;
+
+    // Byte offsets of the two source columns and the weight of the right one
+    std::vector<int> xofs0(dstSize.width), xofs1(dstSize.width), wx(dstSize.width);
+    for (int x = 0; x < dstSize.width; ++x) {
+        double fx = (x + 0.5) * scaleX - 0.5;
+        int sx = static_cast<int>(std::floor(fx));
+        int w = static_cast<int>(std::lround((fx - sx) * kOne));
+        if (sx < 0) { sx = 0; w = 0; }
+        if (sx >= src.cols - 1) { sx = src.cols - 1; w = 0; }
+        xofs0[x] = sx * cn;
+        xofs1[x] = std::min(sx + 1, src.cols - 1) * cn;
+        wx[x] = w;
+    }
+
+    // Channel index feeding R, G, B (gray reads channel 0 three times)
+    const int rIdx = cn == 1 ? 0 : 2;
+    const int gIdx = cn == 1 ? 0 : 1;
+    const int bIdx = 0;
+
+    auto convertRows = [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            double fy = (y + 0.5) * scaleY - 0.5;
+            int sy = static_cast<int>(std::floor(fy));
+            int wy = static_cast<int>(std::lround((fy - sy) * kOne));
+            if (sy < 0) { sy = 0; wy = 0; }
+            if (sy >= src.rows - 1) { sy = src.rows - 1; wy = 0; }
+            const uchar* row0 = src.ptr<uchar>(sy);
+            const uchar* row1 = src.ptr<uchar>(std::min(sy + 1, src.rows - 1));
+            uchar* out = dst.ptr<uchar>(y);
+
+            for (int x = 0; x < dstSize.width; ++x) {
+                const uchar* a0 = row0 + xofs0[x];
+                const uchar* b0 = row0 + xofs1[x];
+                const uchar* a1 = row1 + xofs0[x];
+                const uchar* b1 = row1 + xofs1[x];
+                const int w1 = wx[x], w0 = kOne - w1;
+                const int idx[3] = { rIdx, gIdx, bIdx };
+                for (int c = 0; c < 3; ++c) {
+                    int top = a0[idx[c]] * w0 + b0[idx[c]] * w1;
+                    int bottom = a1[idx[c]] * w0 + b1[idx[c]] * w1;
+                    out[c] = static_cast<uchar>((top * (kOne - wy) + bottom * wy + (1 << (2 * kShift - 1))) >> (2 * kShift));
+                }
+                out[3] = cn == 4 ? static_cast<uchar>(
+                    ((a0[3] * w0 + b0[3] * w1) * (kOne - wy) + (a1[3] * w0 + b1[3] * w1) * wy +
+                     (1 << (2 * kShift - 1))) >> (2 * kShift)) : 255;
+                out += 4;
+            }
+        }
+    };
+
+    // Small previews aren't worth the thread hand-off
+    if (dst.total() >= 256 * 256)
+        cv::parallel_for_(cv::Range(0, dstSize.height), convertRows);
+    else
+        convertRows(cv::Range(0, dstSize.height));
+}
+
+// Converts a cv::Mat to an OpenGL texture.
+// If existingTextureID is zero, a new texture is generated.
+// Node images are BGR/BGRA (as resizeToRGBA() assumes), so 4-channel input is
+// swizzled like everything else; pass alreadyRGBA for CV_8UC4 data that is
+// RGBA already, which is then uploaded without a copy.
+inline GLuint cvMatToTexture(const cv::Mat &mat, GLuint &existingTextureID, bool alreadyRGBA = false) {
+    if (mat.empty())
+        return 0;
+
+    cv::Mat matRGBA;
+    if (alreadyRGBA && mat.type() == CV_8UC4) {
+        matRGBA = mat; // No copy
+    } else {
+        cv::Mat mat8 = mat;
+        if (mat.depth() != CV_8U)
+            mat.convertTo(mat8, CV_8U);
+        int code = mat8.channels() == 1 ? cv::COLOR_GRAY2RGBA
+                 : mat8.channels() == 4 ? cv::COLOR_BGRA2RGBA : cv::COLOR_BGR2RGBA;
+        cv::cvtColor(mat8, matRGBA, code);
+    }
+
+    if (existingTextureID == 0) {
+        glGenTextures(1, &existingTextureID);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, existingTextureID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // Lets ROIs / padded rows upload without being made continuous first
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(matRGBA.step / matRGBA.elemSize()));
+    glTexImage2D(
+        GL_TEXTURE_2D, 0, GL_RGBA,
+        matRGBA.cols, matRGBA.rows, 0,
+        GL_RGBA, GL_UNSIGNED_BYTE, matRGBA.data
+    );
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return existingTextureID;
+}
+
+// Texture that persists across frames for an image that changes rarely.
+//
+// The texture object is created once and reused: uploads go through
+// glTexSubImage2D while the dimensions stay the same, and the storage is only
+// reallocated when they change. Each upload is tagged with a key (typically
+// the output generation) so callers can skip uploads of unchanged images.
+// When pixel buffer objects are available, data is staged through two PBOs
+// used alternately, so the copy to the GPU overlaps with rendering instead of
+// stalling the CPU.
+//
+// release() must be called while the GL context is still current; the
+// destructor does not touch GL because statics outlive the context.
+class PreviewTexture {
+public:
+    // True if the texture already holds an upload with this key and size
+    bool isCurrent(uint64_t uploadKey, int w, int h) const {
+        return texture != 0 && key == uploadKey && width == w && height == h;
+    }
+
+    // Uploads a CV_8UC4 RGBA image tagged with uploadKey
+    GLuint upload(const cv::Mat& rgba, uint64_t uploadKey) {
+        if (rgba.empty() || rgba.type() != CV_8UC4)
+            return texture;
+        return uploadWith(rgba.cols, rgba.rows, uploadKey,
+                          [&](cv::Mat& dst) { rgba.copyTo(dst); });
+    }
+
+    // Like upload(), but 'fill' writes the w x h RGBA pixels straight into the
+    // staging memory (the mapped PBO when available) through a CV_8UC4 header,
+    // so producers such as resizeToRGBA() need no intermediate buffer.
+    template <typename Fill>
+    GLuint uploadWith(int w, int h, uint64_t uploadKey, Fill fill) {
+        if (w <= 0 || h <= 0)
+            return texture;
+        bindStorage(w, h);
+
+        size_t bytes = static_cast<size_t>(w) * h * 4;
+        bool uploaded = false;
+        if (GLEW_ARB_pixel_buffer_object) {
+            if (pbos[0] == 0)
+                glGenBuffers(2, pbos);
+            GLuint pbo = pbos[pboIndex];
+            pboIndex ^= 1;
+
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+            // Orphan the previous storage so mapping never waits on the GPU
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_DRAW);
+            void* mapped = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+            if (mapped) {
+                cv::Mat view(h, w, CV_8UC4, mapped);
+                fill(view);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                // Source is the bound PBO: returns immediately, DMA runs async
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+                uploaded = true;
+            }
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        if (!uploaded) {
+            staging.create(h, w, CV_8UC4);
+            fill(staging);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, staging.data);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        key = uploadKey;
+        return texture;
+    }
+
+    // Frees the GL objects; requires a current context
+    void release() {
+        if (pbos[0] != 0)
+            glDeleteBuffers(2, pbos);
+        if (texture != 0)
+            glDeleteTextures(1, &texture);
+        pbos[0] = pbos[1] = 0;
+        texture = 0;
+        width = height = 0;
+        key = 0;
+        staging.release();
+    }
+
+    GLuint getTextureId() const { return texture; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+private:
+    // Creates the texture on first use, (re)allocates storage when the size
+    // changes and leaves it bound with tightly packed unpack state.
+    void bindStorage(int w, int h) {
+        if (texture == 0) {
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            width = height = 0;
+        } else {
+            glBindTexture(GL_TEXTURE_2D, texture);
+        }
+        if (w != width || h != height) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            width = w;
+            height = h;
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+
+    GLuint texture = 0;
+    GLuint pbos[2] = { 0, 0 };
+    int pboIndex = 0;
+    int width = 0;
+    int height = 0;
+    uint64_t key = 0;
+    cv::Mat staging; // Upload buffer when PBOs are unavailable
+};
+
+} 
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "ProfilerPanel.h"
+#include "tinyfiledialogs.h"
+#include <imgui.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+
+namespace {
+
+ImU32 categoryColor(const char* category) {
+    static const ImU32 palette[] = {
+        IM_COL32(86, 156, 214, 255), IM_COL32(220, 160, 70, 255), IM_COL32(120, 190, 110, 255),
+        IM_COL32(200, 100, 120, 255), IM_COL32(160, 130, 210, 255), IM_COL32(90, 190, 190, 255)
+    };
+    size_t hash = std::hash<std::string>()(category);
+    return palette[hash % (sizeof(palette) / sizeof(palette[0]))];
+}
+
+} // namespace
+
+void ProfilerPanel::draw() {
+    Profiler& profiler = Profiler::instance();
+
+    bool recording = profiler.isEnabled();
+    if (ImGui::Checkbox("Record", &recording))
+        profiler.setEnabled(recording);
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Pause", &paused) && paused) {
+        frozenAt = Profiler::now();
+        frozen = profiler.snapshot();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear")) {
+        profiler.clear();
+        frozen.clear();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export Trace")) {
+        const char* filters[] = { "*.json" };
+        const char* savePath = tinyfd_saveFileDialog("Export Chrome Trace", "trace.json", 1, filters, "Trace Files");
+        if (savePath)
+            profiler.exportChromeTrace(savePath);
+    }
+
+    ImGui::SliderFloat("Bars window (s)", &windowSeconds, 0.5f, 10.0f, "%.1f");
+    ImGui::SliderFloat("Timeline (ms)", &timelineMs, 10.0f, 1000.0f, "%.0f");
+
+    uint64_t now = paused ? frozenAt : Profiler::now();
+    uint64_t windowNs = static_cast<uint64_t>(windowSeconds * 1e9);
+    uint64_t since = now > windowNs ? now - windowNs : 0;
+
+    std::vector<Profiler::Event> events;
+    if (paused) {
+        for (const Profiler::Event& e : frozen) {
+            if (e.startNs >= since)
+                events.push_back(e);
+        }
+    } else {
+        events = profiler.snapshot(since);
+    }
+
+    ImGui::Separator();
+    drawTimeline(events, now);
+    ImGui::Separator();
+    drawBars(events, windowSeconds * 1000.0);
+}
+
+void ProfilerPanel::drawBars(const std::vector<Profiler::Event>& events, double windowMs) {
+    struct Total {
+        uint64_t ns = 0;
+        uint64_t maxNs = 0;
+        int count = 0;
+    };
+    std::map<std::pair<std::string, std::string>, Total> totals;
+    for (const Profiler::Event& e : events) {
+        Total& t = totals[{ e.name, e.category }];
+        t.ns += e.durationNs;
+        t.maxNs = std::max(t.maxNs, e.durationNs);
+        ++t.count;
+    }
+    if (totals.empty()) {
+        ImGui::Text("No events recorded.");
+        return;
+    }
+
+    std::vector<std::pair<std::pair<std::string, std::string>, Total>> sorted(totals.begin(), totals.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto& a, const auto& b) { return a.second.ns > b.second.ns; });
+
+    ImGui::Text("Time per event over the last %.1f s:", windowMs / 1000.0);
+    double largest = static_cast<double>(sorted.front().second.ns);
+    char label[160];
+    for (size_t i = 0; i < sorted.size() && i < 24; ++i) {
+        const Total& t = sorted[i].second;
+        double totalMs = t.ns / 1e6;
+        std::snprintf(label, sizeof(label), "%s [%s]  %.2f ms total, %.2f avg, %.2f max, x%d",
+                      sorted[i].first.first.c_str(), sorted[i].first.second.c_str(), totalMs,
+                      totalMs / t.count, t.maxNs / 1e6, t.count);
+        ImGui::PushStyleColor(ImGuiCol_PlotHistogram, categoryColor(sorted[i].first.second.c_str()));
+        ImGui::ProgressBar(static_cast<float>(t.ns / largest), ImVec2(-1.0f, 0.0f), label);
+        ImGui::PopStyleColor();
+    }
+}
+
+void ProfilerPanel::drawTimeline(const std::vector<Profiler::Event>& events, uint64_t endNs) {
+    uint64_t spanNs = static_cast<uint64_t>(timelineMs * 1e6);
+    uint64_t beginNs = endNs > spanNs ? endNs - spanNs : 0;
+
+    // Events overlapping the span, per thread, in start order
+    std::map<uint32_t, std::vector<const Profiler::Event*>> lanes;
+    for (const Profiler::Event& e : events) {
+        if (e.startNs + e.durationNs >= beginNs && e.startNs <= endNs)
+            lanes[e.thread].push_back(&e);
+    }
+
+    const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    float width = std::max(ImGui::GetContentRegionAvail().x, 50.0f);
+    float scale = width / static_cast<float>(spanNs);
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const Profiler::Event* hovered = nullptr;
+
+    float y = origin.y;
+    for (auto& lane : lanes) {
+        std::vector<const Profiler::Event*>& laneEvents = lane.second;
+        std::sort(laneEvents.begin(), laneEvents.end(),
+                  [](const Profiler::Event* a, const Profiler::Event* b) {
+                      return a->startNs != b->startNs ? a->startNs < b->startNs : a->durationNs > b->durationNs;
+                  });
+
+        // Nesting depth from the stack of enclosing events still running
+        std::vector<uint64_t> openEnds;
+        int laneDepth = 0;
+        for (const Profiler::Event* e : laneEvents) {
+            while (!openEnds.empty() && openEnds.back() <= e->startNs)
+                openEnds.pop_back();
+            int depth = static_cast<int>(openEnds.size());
+            openEnds.push_back(e->startNs + e->durationNs);
+            laneDepth = std::max(laneDepth, depth + 1);
+
+            uint64_t start = std::max(e->startNs, beginNs);
+            uint64_t end = std::min(e->startNs + e->durationNs, endNs);
+            ImVec2 a(origin.x + (start - beginNs) * scale, y + depth * rowHeight);
+            ImVec2 b(std::max(a.x + 1.0f, origin.x + (end - beginNs) * scale), a.y + rowHeight - 1.0f);
+            drawList->AddRectFilled(a, b, categoryColor(e->category));
+            if (b.x - a.x > ImGui::CalcTextSize(e->name).x + 4.0f)
+                drawList->AddText(ImVec2(a.x + 2.0f, a.y + 2.0f), IM_COL32(0, 0, 0, 255), e->name);
+            if (ImGui::IsMouseHoveringRect(a, b))
+                hovered = e;
+        }
+        y += laneDepth * rowHeight + 4.0f;
+    }
+
+    ImGui::Dummy(ImVec2(width, std::max(y - origin.y, rowHeight)));
+    if (lanes.empty())
+        ImGui::Text("No events in the last %.0f ms.", timelineMs);
+    if (hovered)
+        ImGui::SetTooltip("%s [%s]\n%.3f ms", hovered->name, hovered->category, hovered->durationNs / 1e6);
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "Profiler.h"
+#include <string>
+#include <vector>
+
+// Live view of the Profiler: time per event name over the last few seconds as
+// bars, and a flame-style timeline of the most recent events with one lane
+// per thread. Also exports the buffered events as a Chrome trace.
+class ProfilerPanel {
+public:
+    void draw();
+
+private:
+    void drawBars(const std::vector<Profiler::Event>& events, double windowMs);
+    void drawTimeline(const std::vector<Profiler::Event>& events, uint64_t endNs);
+
+    float windowSeconds = 2.0f;   // Span aggregated by the bars
+    float timelineMs = 100.0f;    // Span shown by the timeline
+    bool paused = false;
+    std::vector<Profiler::Event> frozen; // Events shown while paused
+    uint64_t frozenAt = 0;
+};
@@ -0,0 +1,185 @@
+#include "TiledViewer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+void TiledViewer::draw(const PipelineEvaluator::Frame* whole, const PipelineEvaluator::Frame* detail) {
+    ImVec2 avail = ImGui::GetContentRegionAvail();
+    viewSize = ImVec2(std::max(avail.x, 16.0f), std::max(avail.y, 16.0f));
+    if (!whole || whole->image.empty() || whole->region.empty()) {
+        ImGui::Text("No output image available.");
+        visible = cv::Rect();
+        return;
+    }
+
+    viewOrigin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("##viewer", viewSize);
+    bool hovered = ImGui::IsItemHovered();
+    bool active = ImGui::IsItemActive();
+
+    // A different image size means a different image: start from the fit view
+    if (whole->region.size() != extent) {
+        extent = whole->region.size();
+        fit = true;
+    }
+    double fitZoom = std::min(viewSize.x / extent.width, viewSize.y / extent.height);
+    handleInput(viewOrigin, hovered, active, fitZoom);
+
+    double halfW = viewSize.x / (2.0 * zoom), halfH = viewSize.y / (2.0 * zoom);
+    cv::Point tl(static_cast<int>(std::floor(center.x - halfW)), static_cast<int>(std::floor(center.y - halfH)));
+    cv::Point br(static_cast<int>(std::ceil(center.x + halfW)), static_cast<int>(std::ceil(center.y + halfH)));
+    visible = cv::Rect(tl, br) & cv::Rect(cv::Point(), extent);
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    ImVec2 viewEnd(viewOrigin.x + viewSize.x, viewOrigin.y + viewSize.y);
+    drawList->PushClipRect(viewOrigin, viewEnd, true);
+    drawList->AddRectFilled(viewOrigin, viewEnd, IM_COL32(30, 30, 34, 255));
+    try {
+        int uploads = kUploadsPerFrame;
+        drawOverview(*whole, drawList);
+        drawTiles(*whole, drawList, uploads, true);
+        if (detail && !detail->image.empty())
+            drawTiles(*detail, drawList, uploads, false);
+    } catch (const cv::Exception& e) {
+        ImGui::SetTooltip("Failed to generate preview: %s", e.what());
+    }
+    drawList->PopClipRect();
+
+    if (hovered)
+        ImGui::SetTooltip("%.0f%%  (wheel: zoom, drag: pan, double-click: fit)", zoom * 100.0);
+}
+
+void TiledViewer::handleInput(const ImVec2& origin, bool hovered, bool active, double fitZoom) {
+    ImGuiIO& io = ImGui::GetIO();
+    ImVec2 middle(origin.x + viewSize.x * 0.5f, origin.y + viewSize.y * 0.5f);
+
+    if (hovered && ImGui::IsMouseDoubleClicked(0))
+        fit = true;
+    if (fit) {
+        zoom = fitZoom;
+        center = cv::Point2d(extent.width * 0.5, extent.height * 0.5);
+    }
+
+    if (hovered && io.MouseWheel != 0.0f) {
+        // Keep the output point under the cursor in place
+        double mx = io.MousePos.x - middle.x, my = io.MousePos.y - middle.y;
+        cv::Point2d under(center.x + mx / zoom, center.y + my / zoom);
+        zoom = std::min(std::max(zoom * std::pow(1.25, io.MouseWheel), fitZoom * 0.5), 32.0);
+        center = cv::Point2d(under.x - mx / zoom, under.y - my / zoom);
+        fit = false;
+    }
+    if (active && ImGui::IsMouseDragging(0)) {
+        center.x -= io.MouseDelta.x / zoom;
+        center.y -= io.MouseDelta.y / zoom;
+        fit = false;
+    }
+    center.x = std::min(std::max(center.x, 0.0), static_cast<double>(extent.width));
+    center.y = std::min(std::max(center.y, 0.0), static_cast<double>(extent.height));
+}
+
+ImVec2 TiledViewer::toScreen(double x, double y) const {
+    return ImVec2(static_cast<float>(viewOrigin.x + viewSize.x * 0.5 + (x - center.x) * zoom),
+                  static_cast<float>(viewOrigin.y + viewSize.y * 0.5 + (y - center.y) * zoom));
+}
+
+// Coarsest pyramid level of the frame as one texture, stretched over the
+// whole output: the backdrop while finer tiles are missing
+void TiledViewer::drawOverview(const PipelineEvaluator::Frame& frame, ImDrawList* drawList) {
+    cv::Mat level = frame.pyramid->level(frame.pyramid->getBuiltLevels() - 1);
+    cv::Size size = level.size();
+    int maxWidth = std::max(getViewWidth(), 64);
+    if (size.width > 2 * maxWidth) {
+        // Levels not built yet (view size unknown when the frame was made)
+        size = cv::Size(maxWidth, std::max(1, size.height * maxWidth / size.width));
+    }
+    if (!overview.isCurrent(frame.generation, size.width, size.height)) {
+        ProfileScope uploadScope("Preview upload", "texture");
+        overview.uploadWith(size.width, size.height, frame.generation, [&](cv::Mat& rgba) {
+            OpenGLHelper::resizeToRGBA(level, size, rgba);
+        });
+    }
+    const cv::Rect& r = frame.region;
+    drawList->AddImage((ImTextureID)(uintptr_t)overview.getTextureId(), toScreen(r.x, r.y),
+                       toScreen(r.x + r.width, r.y + r.height));
+}
+
+void TiledViewer::drawTiles(const PipelineEvaluator::Frame& frame, ImDrawList* drawList, int& uploads,
+                            bool overOverview) {
+    cv::Rect shown = visible & frame.region;
+    if (shown.empty())
+        return;
+
+    // Coarsest level with at least one of its pixels per screen pixel,
+    // among those built
+    int built = frame.pyramid->getBuiltLevels();
+    double perScreenPixel = frame.scale / zoom;
+    int level = 0;
+    while (level + 1 < built && std::ldexp(1.0, level + 1) <= perScreenPixel)
+        ++level;
+
+    cv::Mat image = frame.pyramid->level(level);
+    if (overOverview && image.cols == overview.getWidth())
+        return; // Already on screen as the overview
+    double fx = static_cast<double>(image.cols) / frame.region.width;
+    double fy = static_cast<double>(image.rows) / frame.region.height;
+    int x0 = static_cast<int>((shown.x - frame.region.x) * fx) / kTileSize;
+    int y0 = static_cast<int>((shown.y - frame.region.y) * fy) / kTileSize;
+    int x1 = std::min(static_cast<int>(std::ceil((shown.br().x - frame.region.x) * fx / kTileSize)),
+                      (image.cols + kTileSize - 1) / kTileSize);
+    int y1 = std::min(static_cast<int>(std::ceil((shown.br().y - frame.region.y) * fy / kTileSize)),
+                      (image.rows + kTileSize - 1) / kTileSize);
+
+    for (int ty = y0; ty < y1; ++ty) {
+        for (int tx = x0; tx < x1; ++tx) {
+            TileKey key = { frame.generation, level, tx, ty };
+            cv::Rect t = cv::Rect(tx * kTileSize, ty * kTileSize, kTileSize, kTileSize) &
+                         cv::Rect(0, 0, image.cols, image.rows);
+            GLuint texture = findTile(key);
+            if (texture == 0) {
+                if (uploads <= 0)
+                    continue; // Next frame; the overview shows through
+                --uploads;
+                texture = addTile(key, image(t));
+            }
+            ImVec2 a = toScreen(frame.region.x + t.x / fx, frame.region.y + t.y / fy);
+            ImVec2 b = toScreen(frame.region.x + t.br().x / fx, frame.region.y + t.br().y / fy);
+            drawList->AddImage((ImTextureID)(uintptr_t)texture, a, b);
+        }
+    }
+}
+
+GLuint TiledViewer::findTile(const TileKey& key) {
+    auto it = tileIndex.find(key);
+    if (it == tileIndex.end())
+        return 0;
+    tiles.splice(tiles.begin(), tiles, it->second); // Most recently used
+    return it->second->texture;
+}
+
+GLuint TiledViewer::addTile(const TileKey& key, const cv::Mat& pixels) {
+    ProfileScope scope("Tile upload", "texture");
+    GLuint texture = 0;
+    OpenGLHelper::cvMatToTexture(pixels, texture);
+    // Neighbouring tiles must not bleed in through linear filtering
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    tiles.push_front({ key, texture });
+    tileIndex[key] = tiles.begin();
+    while (tiles.size() > kMaxTiles) {
+        glDeleteTextures(1, &tiles.back().texture);
+        tileIndex.erase(tiles.back().key);
+        tiles.pop_back();
+    }
+    return texture;
+}
+
+void TiledViewer::release() {
+    for (Tile& tile : tiles)
+        glDeleteTextures(1, &tile.texture);
+    tiles.clear();
+    tileIndex.clear();
+    overview.release();
+}
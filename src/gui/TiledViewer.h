@@ -0,0 +1,85 @@
+#pragma once
+#include "PipelineEvaluator.h"
+#include "OpenGLHelper.h"
+#include <imgui.h>
+#include <GL/glew.h>
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+// Zoomable, pannable view of the evaluator's frames.
+//
+// The output is drawn as 256-pixel tiles cut from the frame's pyramid level
+// closest to screen resolution, so only what is visible is ever uploaded and
+// zooming out never touches full-resolution pixels. Tile textures are kept in
+// an LRU cache keyed by frame generation, level and position; a few new
+// tiles are uploaded per UI frame and the coarsest level, drawn underneath,
+// fills in until they arrive. A detail frame (the refined viewport) is drawn
+// over the whole-image frame the same way.
+//
+// Mouse wheel zooms around the cursor, dragging pans, double-click fits the
+// image to the window. The visible region and zoom are fed back to the
+// evaluator (PipelineEvaluator::setViewport) by the caller.
+//
+// release() must be called while the GL context is still current.
+class TiledViewer {
+public:
+    // Draws into the remaining space of the current window
+    void draw(const PipelineEvaluator::Frame* whole, const PipelineEvaluator::Frame* detail);
+
+    // Part of the output on screen, in full-resolution pixels
+    cv::Rect getVisibleRegion() const { return visible; }
+    // Screen pixels per full-resolution pixel
+    double getZoom() const { return zoom; }
+    // Width of the view in screen pixels
+    int getViewWidth() const { return static_cast<int>(viewSize.x); }
+
+    void release();
+
+private:
+    struct TileKey {
+        uint64_t generation;
+        int level;
+        int x, y;
+        bool operator==(const TileKey& o) const {
+            return generation == o.generation && level == o.level && x == o.x && y == o.y;
+        }
+    };
+    struct TileKeyHash {
+        size_t operator()(const TileKey& k) const {
+            size_t h = std::hash<uint64_t>()(k.generation);
+            h = h * 31 + static_cast<size_t>(k.level);
+            h = h * 1000003 + static_cast<size_t>(k.x);
+            return h * 1000003 + static_cast<size_t>(k.y);
+        }
+    };
+    struct Tile {
+        TileKey key;
+        GLuint texture;
+    };
+
+    void handleInput(const ImVec2& origin, bool hovered, bool active, double fitZoom);
+    void drawOverview(const PipelineEvaluator::Frame& frame, ImDrawList* drawList);
+    void drawTiles(const PipelineEvaluator::Frame& frame, ImDrawList* drawList, int& uploads,
+                   bool overOverview);
+    ImVec2 toScreen(double x, double y) const;
+    GLuint findTile(const TileKey& key);
+    GLuint addTile(const TileKey& key, const cv::Mat& pixels);
+
+    static constexpr int kTileSize = 256;
+    static constexpr size_t kMaxTiles = 256;   // 64 MB of RGBA textures
+    static constexpr int kUploadsPerFrame = 8; // Keeps the UI frame short
+
+    std::list<Tile> tiles; // Most recently used first
+    std::unordered_map<TileKey, std::list<Tile>::iterator, TileKeyHash> tileIndex;
+    OpenGLHelper::PreviewTexture overview; // Coarsest level of the whole-image frame
+
+    cv::Size extent;        // Full-resolution size of the output
+    cv::Point2d center;     // Output point at the middle of the view
+    double zoom = 1.0;
+    bool fit = true;        // Zoom follows the window size
+    ImVec2 viewOrigin;
+    ImVec2 viewSize = ImVec2(0.0f, 0.0f);
+    cv::Rect visible;
+};
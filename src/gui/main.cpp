@@ -0,0 +1,263 @@
+#include "Pipeline.h"
+#include "PipelineEvaluator.h"
+#include "BufferPool.h"
+#include "GraphFile.h"
+#include <opencv2/opencv.hpp>
+#include <imgui.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_opengl3.h>
+#include "OpenGLHelper.h"
+#include "NodeBase.h"
+#include <string>
+#include "tinyfiledialogs.h"
+#include "NodePanels.h"
+#include "ProfilerPanel.h"
+#include "TiledViewer.h"
+
+// Function declarations
+void initGLFW();
+void initImGui();
+void shutdownImGui();
+void renderUI();
+void usePipeline(std::unique_ptr<Pipeline> next);
+void saveOutputImage();
+
+// Nodes and graph being edited, and the thread evaluating them
+static std::unique_ptr<Pipeline> pipeline;
+static std::unique_ptr<PipelineEvaluator> evaluator;
+static TiledViewer previewViewer;
+static NodePanels nodePanels;
+static ProfilerPanel profilerPanel;
+static bool showProfiler = false;
+static ThreadPool* threadPool = nullptr;
+
+GLFWwindow* window = nullptr;
+NodeBase* selectedNode = nullptr;
+
+float fontScale = 1.5f;
+
+int main() {
+    // Recycle image buffers across evaluations instead of reallocating them
+    BufferPool::install();
+    Profiler::instance().setEnabled(true);
+
+    initGLFW();
+    initImGui();
+
+    // Independent branches of the graph are evaluated on this pool
+    ThreadPool pool;
+    threadPool = &pool;
+    usePipeline(Pipeline::createDefault());
+
+    while (!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+        renderUI();
+    }
+
+    evaluator->stop();
+    previewViewer.release();
+    nodePanels.release();
+
+    shutdownImGui();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
+
+// Replaces the pipeline being edited, keeping the loaded image
+void usePipeline(std::unique_ptr<Pipeline> next) {
+    if (evaluator)
+        evaluator->stop();
+    if (pipeline) {
+        // The evaluation thread is stopped, so the old input can be read freely
+        next->getInput()->setInputImage(pipeline->getInput()->getOutputImage());
+    }
+    selectedNode = nullptr;
+    evaluator.reset();
+    pipeline = std::move(next);
+
+    pipeline->getGraph().setThreadPool(threadPool);
+
+    // The graph is evaluated off the UI thread
+    evaluator = std::make_unique<PipelineEvaluator>(pipeline->getGraph(), *pipeline->getOutput());
+    evaluator->enableProxy(*pipeline); // Preview-sized feedback while editing
+    evaluator->start();
+}
+
+// Asks for a path and writes the full-resolution output there
+void saveOutputImage() {
+    const char* savePath = tinyfd_saveFileDialog("Save Image", "output.jpg", 0, nullptr, "Image Files");
+    if (savePath) {
+        // The evaluator may only have rendered the part on screen (or a
+        // proxy); bring the whole output up to date before writing it
+        evaluator->evaluateWhole();
+        pipeline->getOutput()->saveImage(savePath);
+    }
+}
+
+void initGLFW() {
+    if (!glfwInit()) {
+        std::cerr << "GLFW init failed!\n";
+        exit(1);
+    }
+    window = glfwCreateWindow(1280, 720, "Node-Based Image Processing", nullptr, nullptr);
+    if (!window) {
+        glfwTerminate();
+        std::cerr << "Window creation failed!\n";
+        exit(1);
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(1);
+
+    // Loads GL entry points beyond 1.1 (buffer objects used for preview uploads)
+    if (glewInit() != GLEW_OK) {
+        std::cerr << "GLEW init failed, falling back to basic texture uploads\n";
+    }
+}
+
+void initImGui() {
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.FontGlobalScale = fontScale;
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard | ImGuiConfigFlags_NavEnableGamepad;
+    ImGui::StyleColorsDark();
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 130");
+}
+
+void shutdownImGui() {
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+}
+
+void renderUI() {
+    ProfileScope frameScope("UI frame", "ui");
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui_ImplGlfw_NewFrame();
+    ImGui::NewFrame();
+
+    int display_w, display_h;
+    glfwGetFramebufferSize(window, &display_w, &display_h);
+
+    ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(display_w, 50), ImGuiCond_Always);
+    ImGui::Begin("Title", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize);
+    ImGui::SetCursorPosX((ImGui::GetWindowSize().x - ImGui::CalcTextSize("Node Based Manipulation Interface").x) * 0.5f);
+    ImGui::Text("Node Based Manipulation Interface");
+    ImGui::End();
+
+    // File Operations Window
+    ImGui::SetNextWindowPos(ImVec2(0, 50), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(display_w * 0.25f, display_h - 50), ImGuiCond_Always);
+    ImGui::Begin("File Operations", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
+    if (ImGui::Button("Open Image")) {
+        const char* filters[] = { "*.jpg", "*.png", "*.bmp" };
+        const char* filePath = tinyfd_openFileDialog("Select an Image", "", 3, filters, "Image Files", 0);
+        if (filePath) {
+            ImageInputNode* input = pipeline->getInput();
+            input->loadImage(filePath);
+            BufferPool::instance().trim(); // Cached sizes belong to the old image
+            evaluator->requestEvaluation(input);
+            selectedNode = input;
+        }
+    }
+    if (ImGui::Button("Save Image"))
+        saveOutputImage();
+    if (ImGui::Button("Load Graph")) {
+        const char* filters[] = { "*.ngraph", "*.ngb" };
+        const char* filePath = tinyfd_openFileDialog("Load Graph", "", 2, filters, "Node Graphs", 0);
+        GraphDesc desc;
+        if (filePath && GraphFile::load(filePath, desc)) {
+            std::unique_ptr<Pipeline> loaded = Pipeline::create(desc);
+            if (loaded)
+                usePipeline(std::move(loaded));
+        }
+    }
+    if (ImGui::Button("Save Graph")) {
+        // .ngb saves the binary form, anything else the text form
+        const char* filters[] = { "*.ngraph", "*.ngb" };
+        const char* savePath = tinyfd_saveFileDialog("Save Graph", "pipeline.ngraph", 2, filters, "Node Graphs");
+        if (savePath) {
+            GraphFile::save(savePath, pipeline->describe());
+        }
+    }
+
+    BufferPool::Stats poolStats = BufferPool::instance().getStats();
+    ImGui::Separator();
+    ImGui::Text("Buffer pool: %.0f%% hits", poolStats.hitRate() * 100.0);
+    ImGui::Text("In use %.1f MB, cached %.1f MB, peak %.1f MB",
+                poolStats.bytesInUse / 1048576.0, poolStats.bytesCached / 1048576.0,
+                poolStats.peakBytes / 1048576.0);
+    ImGui::Separator();
+    ImGui::Checkbox("Show Profiler", &showProfiler);
+    ImGui::End();
+
+    // Node Selection Window
+    ImGui::SetNextWindowPos(ImVec2(display_w * 0.25f, 50), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(display_w * 0.25f, display_h - 50), ImGuiCond_Always);
+    ImGui::Begin("Node Selection", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
+    for (const std::unique_ptr<NodeBase>& node : pipeline->getNodes()) {
+        if (ImGui::Button(node->getNodeName().c_str())) selectedNode = node.get();
+    }
+    ImGui::End();
+
+    // Properties Window
+    ImGui::SetNextWindowPos(ImVec2(display_w * 0.5f, 50), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(display_w * 0.25f, display_h - 50), ImGuiCond_Always);
+    ImGui::Begin("Properties", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
+    if (selectedNode) {
+        // Node state is shared with the evaluation thread
+        std::lock_guard<std::mutex> lock(selectedNode->stateMutex);
+        uint64_t paramsBefore = selectedNode->paramGeneration;
+        nodePanels.draw(*selectedNode);
+        if (selectedNode->paramGeneration != paramsBefore)
+            evaluator->requestEvaluation(selectedNode);
+    } else {
+        ImGui::Text("No node selected.");
+    }
+    if (nodePanels.takeSaveRequest())
+        saveOutputImage(); // Outside the node's lock
+    ImGui::End();
+
+    // Preview Window
+    ImGui::SetNextWindowPos(ImVec2(display_w * 0.75f, 50), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(display_w * 0.25f, display_h - 50), ImGuiCond_Always);
+    ImGui::Begin("Preview", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
+
+    // Last frames finished by the evaluation thread; never waits for the
+    // evaluation in progress.
+    std::shared_ptr<const PipelineEvaluator::Frame> frame = evaluator->getLatestFrame();
+    std::shared_ptr<const PipelineEvaluator::Frame> detail = evaluator->getDetailFrame();
+    if (evaluator->isBusy()) {
+        ImGui::Text("Processing...");
+    } else if (evaluator->isRefining()) {
+        ImGui::Text("Preview resolution, refining...");
+    } else {
+        ImGui::Text("Ready");
+    }
+    previewViewer.draw(frame.get(), detail.get());
+
+    // Proxies are rendered to exactly cover the view, and refinement only
+    // renders the part on screen
+    evaluator->setProxyWidth(previewViewer.getViewWidth());
+    evaluator->setViewport(previewViewer.getVisibleRegion(), previewViewer.getZoom());
+    ImGui::End();
+
+    if (showProfiler) {
+        ImGui::SetNextWindowSize(ImVec2(display_w * 0.5f, display_h * 0.5f), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Profiler", &showProfiler);
+        profilerPanel.draw();
+        ImGui::End();
+    }
+
+    ImGui::Render();
+    glViewport(0, 0, display_w, display_h);
+    glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    glfwSwapBuffers(window);
+}